@@ -0,0 +1,89 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Dirty tracking for coefficients computed from a few parameters which are,
+// most of the time, static.
+//
+// The parameters are quantised before being compared, so that values still
+// settling through a one-pole smoother, or jittering in their last bits, count
+// as unchanged. The cached coefficients are then those computed for the first
+// value seen within the quantisation step.
+
+#ifndef PLAITS_DSP_COEFFICIENT_CACHE_H_
+#define PLAITS_DSP_COEFFICIENT_CACHE_H_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace plaits {
+
+template <size_t num_parameters> class CoefficientCache {
+public:
+  using Key = std::array<uint32_t, num_parameters>;
+
+  // A frequency (or any positive parameter on a log scale), in steps of about
+  // 0.2 cent: the 10 least significant bits of the mantissa are dropped.
+  static inline uint32_t Frequency(float f) {
+    return std::bit_cast<uint32_t>(f) >> 10;
+  }
+
+  // A parameter within [-1, 1], in steps of 2^-16. The steps are fine enough
+  // for the steepest parameter curves (the resonator's stiffness), so the
+  // cache only kicks in once a smoothed parameter has nearly settled.
+  static inline uint32_t Unit(float x) {
+    return static_cast<uint32_t>(static_cast<int32_t>(x * 65536.0f));
+  }
+
+  // Returns true if the coefficients have to be recomputed for this key, which
+  // then becomes the cached one.
+  inline bool Miss(const Key &key) {
+    if (valid_ && key == key_) {
+      ++num_hits_;
+      return false;
+    }
+    key_ = key;
+    valid_ = true;
+    ++num_misses_;
+    return true;
+  }
+
+  // Forces a recomputation, when the coefficients depend on something else
+  // than the key.
+  inline void Invalidate() { valid_ = false; }
+
+  inline size_t num_hits() const { return num_hits_; }
+  inline size_t num_misses() const { return num_misses_; }
+
+private:
+  Key key_{};
+  bool valid_{};
+  size_t num_hits_{};
+  size_t num_misses_{};
+};
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_COEFFICIENT_CACHE_H_
@@ -39,7 +39,7 @@ using namespace std;
 using namespace stmlib;
 
 void AdditiveEngine::Init(BufferAllocator* allocator) {
-  amplitudes_ = allocator->Allocate<float>(kNumHarmonics);
+  amplitudes_.Init(allocator);
   for (int i = 0; i < kNumHarmonicOscillators; ++i) {
     harmonic_oscillator_[i].Init();
   }
@@ -120,7 +120,7 @@ void AdditiveEngine::Render(
     float* aux,
     size_t size,
     bool* already_enveloped) {
-  const float f0 = NoteToFrequency(parameters.note);
+  const float f0 = NoteToInc(parameters.note);
 
   const float centroid = parameters.timbre;
   const float raw_bumps = parameters.harmonics;
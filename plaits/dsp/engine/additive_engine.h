@@ -30,6 +30,7 @@
 #define PLAITS_DSP_ENGINE_ADDITIVE_ENGINE_H_
 
 #include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/engine/engine_buffer.h"
 #include "plaits/dsp/oscillator/harmonic_oscillator.h"
 
 namespace plaits {
@@ -38,15 +39,20 @@ const int kHarmonicBatchSize = 12;
 const int kNumHarmonics = 36;
 const int kNumHarmonicOscillators = kNumHarmonics / kHarmonicBatchSize;
 
-class AdditiveEngine : public Engine {
+class AdditiveEngine {
  public:
   AdditiveEngine() { }
   ~AdditiveEngine() { }
   
-  virtual void Init(stmlib::BufferAllocator* allocator);
-  virtual void Reset();
-  virtual void LoadUserData(const uint8_t* user_data) { }
-  virtual void Render(const EngineParameters& parameters,
+  using AmplitudesBuffer = EngineBuffer<float, kNumHarmonics>;
+  
+  // Bytes carved from the shared RAM by Init().
+  static const size_t kSharedRamSize = AmplitudesBuffer::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator* allocator);
+  void Reset();
+  void LoadUserData(const uint8_t* user_data) { }
+  void Render(const EngineParameters& parameters,
       float* out,
       float* aux,
       size_t size,
@@ -63,7 +69,7 @@ class AdditiveEngine : public Engine {
       
   HarmonicOscillator<kHarmonicBatchSize> harmonic_oscillator_[kNumHarmonicOscillators];
   
-  float* amplitudes_;
+  AmplitudesBuffer amplitudes_;
   
   DISALLOW_COPY_AND_ASSIGN(AdditiveEngine);
 };
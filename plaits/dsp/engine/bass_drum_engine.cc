@@ -36,7 +36,7 @@ using namespace std;
 using namespace stmlib;
 
 void BassDrumEngine::Render(const EngineParameters &parameters, float *out,
-                            float *aux, size_t size) {
+                            float *aux, size_t size, bool *already_enveloped) {
   const float f0 = NoteToInc(parameters.note);
 
   const float attack_fm_amount = min(parameters.harmonics * 4.0f, 1.0f);
@@ -39,9 +39,10 @@ namespace plaits {
 
 class BassDrumEngine {
 public:
+  void Reset() {}
   void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
-              size_t size);
+              size_t size, bool *already_enveloped);
 
 private:
   AnalogBassDrum analog_bass_drum_{};
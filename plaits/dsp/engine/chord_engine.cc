@@ -42,14 +42,12 @@ void ChordEngine::Init(BufferAllocator* allocator) {
     divide_down_voice_[i].Init();
     wavetable_voice_[i].Init();
   }
-  chords_.Init(allocator);
   
   morph_lp_ = 0.0f;
   timbre_lp_ = 0.0f;
 }
 
 void ChordEngine::Reset() {
-  chords_.Reset();
 }
 
 const float fade_point[kChordNumVoices] = {
@@ -101,12 +99,14 @@ const int16_t* const wavetable[] = {
   WAVE(2, 4, 0),
 };
 
-void ChordEngine::Render(
+template<size_t block_size>
+void ChordEngine::RenderBlock(
     const EngineParameters& parameters,
     float* out,
     float* aux,
-    size_t size,
+    size_t runtime_size,
     bool* already_enveloped) {
+  const size_t size = block_size ? block_size : runtime_size;
   ONE_POLE(morph_lp_, parameters.morph, 0.1f);
   ONE_POLE(timbre_lp_, parameters.timbre, 0.1f);
 
@@ -128,7 +128,7 @@ void ChordEngine::Render(
   fill(&out[0], &out[size], 0.0f);
   fill(&aux[0], &aux[size], 0.0f);
   
-  const float f0 = NoteToFrequency(parameters.note) * 0.998f;
+  const float f0 = NoteToInc(parameters.note) * 0.998f;
   const float waveform = max((morph_lp_ - 0.535f) * 2.15f, 0.0f);
   
   for (int note = 0; note < kChordNumVoices; ++note) {
@@ -169,4 +169,16 @@ void ChordEngine::Render(
   }
 }
 
+void ChordEngine::Render(
+    const EngineParameters& parameters,
+    float* out,
+    float* aux,
+    size_t size,
+    bool* already_enveloped) {
+  DispatchBlockSize(size, [&](auto block_size) {
+    RenderBlock<decltype(block_size)::value>(
+        parameters, out, aux, size, already_enveloped);
+  });
+}
+
 }  // namespace plaits
@@ -38,21 +38,28 @@ namespace plaits {
 
 const int kChordNumHarmonics = 3;
 
-class ChordEngine : public Engine {
+class ChordEngine {
  public:
   ChordEngine() { }
   ~ChordEngine() { }
   
-  virtual void Init(stmlib::BufferAllocator* allocator);
-  virtual void Reset();
-  virtual void LoadUserData(const uint8_t* user_data) { }
-  virtual void Render(const EngineParameters& parameters,
+  void Init(stmlib::BufferAllocator* allocator);
+  void Reset();
+  void LoadUserData(const uint8_t* user_data) { }
+  void Render(const EngineParameters& parameters,
       float* out,
       float* aux,
       size_t size,
       bool* already_enveloped);
 
  private:
+  template<size_t block_size>
+  void RenderBlock(const EngineParameters& parameters,
+      float* out,
+      float* aux,
+      size_t runtime_size,
+      bool* already_enveloped);
+
   void ComputeRegistration(float registration, float* amplitudes);
   int ComputeChordInversion(
       float inversion,
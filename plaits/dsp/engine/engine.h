@@ -24,7 +24,7 @@
 //
 // -----------------------------------------------------------------------------
 //
-// Base class for all engines.
+// Interface and registry for all engines.
 
 #ifndef PLAITS_DSP_ENGINE_ENGINE_H_
 #define PLAITS_DSP_ENGINE_ENGINE_H_
@@ -32,6 +32,14 @@
 #include "stmlib/utils/buffer_allocator.h"
 #include "synth/phase_step_table.hh"
 
+#include "plaits/dsp/dsp.h"
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
 namespace plaits {
 
 inline float NoteToInc(float midi_note) {
@@ -73,45 +81,124 @@ struct PostProcessingSettings {
   bool already_enveloped;
 };
 
-class Engine {
-public:
-  Engine() {}
-  ~Engine() {}
-  virtual void Init(stmlib::BufferAllocator *allocator) = 0;
-  virtual void Reset() = 0;
-  virtual void LoadUserData(const uint8_t *user_data) = 0;
-  virtual void Render(const EngineParameters &parameters, float *out,
-                      float *aux, size_t size, bool *already_enveloped) = 0;
-  PostProcessingSettings post_processing_settings;
+// Engines do not derive from a common base class. Instead, the interface
+// below is checked at compile time, and the registry dispatches to the
+// concrete type with a switch: there is no vtable, and each engine's Render()
+// can be inlined in the voice.
+template <typename T>
+concept EngineInterface = requires(T &engine,
+                                   const EngineParameters &parameters,
+                                   const uint8_t *user_data, float *out,
+                                   float *aux, size_t size,
+                                   bool *already_enveloped) {
+  engine.Reset();
+  engine.LoadUserData(user_data);
+  engine.Render(parameters, out, aux, size, already_enveloped);
 };
 
-template <int max_size> class EngineRegistry {
+// Engines either carve their buffers from the shared RAM, initialize their
+// own state, or have nothing to do (all members brace-initialized).
+template <EngineInterface T>
+inline void InitEngine(T &engine, stmlib::BufferAllocator *allocator) {
+  if constexpr (requires { engine.Init(allocator); }) {
+    engine.Init(allocator);
+  } else if constexpr (requires { engine.Init(); }) {
+    engine.Init();
+  }
+}
+
+// Bytes an engine carves from the shared RAM in Init(). Engines using the
+// allocator declare it as kSharedRamSize.
+template <typename T> inline constexpr size_t kEngineSharedRamSize = 0;
+
+template <typename T>
+  requires requires { T::kSharedRamSize; }
+inline constexpr size_t kEngineSharedRamSize<T> = T::kSharedRamSize;
+
+// Block sizes for which the render paths of some engines are compiled with a
+// constant size, so that their loops can be unrolled and the 1/size of the
+// parameter interpolators folded. Other sizes go through the generic path.
+// Only the engines for which plaits_bench shows a gain use it (chord, snare
+// drum and swarm at the time of writing).
+using SpecialisedBlockSizes = std::index_sequence<16, 32, 64>;
+
+template <typename F, size_t... block_sizes>
+inline void DispatchBlockSize(size_t size, F &&fn,
+                              std::index_sequence<block_sizes...>) {
+  const bool specialised =
+      ((block_sizes <= kMaxBlockSize && size == block_sizes &&
+        (fn(std::integral_constant<size_t, block_sizes>{}), true)) ||
+       ...);
+  if (!specialised) {
+    fn(std::integral_constant<size_t, 0>{});
+  }
+}
+
+// Calls fn(std::integral_constant<size_t, block_size>) with block_size = size
+// if size is one of the specialised block sizes, and with block_size = 0
+// otherwise.
+template <typename F> inline void DispatchBlockSize(size_t size, F &&fn) {
+  DispatchBlockSize(size, std::forward<F>(fn), SpecialisedBlockSizes{});
+}
+
+template <int max_size, EngineInterface... Engines> class EngineRegistry {
 public:
-  EngineRegistry() {}
-  ~EngineRegistry() {}
+  using Instance = std::variant<Engines *...>;
 
-  void Init() { num_engines_ = 0; }
+  // Memory footprint of the registered engine types. Each engine object is
+  // owned by the voice, while only one engine at a time uses the shared RAM.
+  static constexpr size_t kMaxStateSize = std::max({sizeof(Engines)...});
+  static constexpr size_t kTotalStateSize = (sizeof(Engines) + ...);
+  static constexpr size_t kMaxSharedRamSize =
+      std::max({kEngineSharedRamSize<Engines>...});
+  static constexpr size_t kTotalSharedRamSize =
+      (kEngineSharedRamSize<Engines> + ...);
 
-  inline Engine *get(int index) { return engine_[index]; }
+  void Init() { num_engines_ = 0; }
 
-  void RegisterInstance(Engine *instance, bool already_enveloped,
-                        float out_gain, float aux_gain) {
+  // The same instance can be registered several times (for example with
+  // different user data banks).
+  template <EngineInterface T>
+  void RegisterInstance(T *instance, bool already_enveloped, float out_gain,
+                        float aux_gain) {
     if (num_engines_ >= max_size) {
       return;
     }
     engine_[num_engines_] = instance;
-    PostProcessingSettings *s = &instance->post_processing_settings;
+    PostProcessingSettings *s = &post_processing_settings_[num_engines_];
     s->already_enveloped = already_enveloped;
     s->out_gain = out_gain;
     s->aux_gain = aux_gain;
     ++num_engines_;
   }
 
+  // Calls fn with a reference to the engine registered at index.
+  template <typename F> inline void Dispatch(int index, F &&fn) {
+    Dispatch(engine_[index], fn, std::index_sequence_for<Engines...>{});
+  }
+
+  inline const PostProcessingSettings &post_processing_settings(
+      int index) const {
+    return post_processing_settings_[index];
+  }
+
   inline int size() const { return num_engines_; }
 
+  inline bool same_instance(int a, int b) const {
+    return engine_[a] == engine_[b];
+  }
+
 private:
-  Engine *engine_[max_size];
-  int num_engines_;
+  template <typename F, size_t... I>
+  static inline void Dispatch(Instance &instance, F &fn,
+                              std::index_sequence<I...>) {
+    const size_t type = instance.index();
+    ((type == I ? fn(**std::get_if<I>(&instance)) : void()), ...);
+  }
+
+  std::array<Instance, max_size> engine_{};
+  std::array<PostProcessingSettings, max_size> post_processing_settings_{};
+  int num_engines_{};
 };
 
 } // namespace plaits
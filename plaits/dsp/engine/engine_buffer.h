@@ -0,0 +1,81 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Scratch and state buffers owned by an engine.
+//
+// By default the buffer is embedded in the engine, so that sizeof(engine) is
+// its complete footprint. When PLAITS_SHARED_ENGINE_RAM is defined, the buffer
+// is instead carved from the shared RAM handed to Init(), which only one
+// engine uses at a time: the buffers of mutually exclusive engines then overlap
+// and the voice only pays for the largest of them.
+
+#ifndef PLAITS_DSP_ENGINE_ENGINE_BUFFER_H_
+#define PLAITS_DSP_ENGINE_ENGINE_BUFFER_H_
+
+#include "stmlib/utils/buffer_allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace plaits {
+
+#ifdef PLAITS_SHARED_ENGINE_RAM
+inline constexpr bool kSharedEngineRam = true;
+#else
+inline constexpr bool kSharedEngineRam = false;
+#endif // PLAITS_SHARED_ENGINE_RAM
+
+template <typename T, size_t buffer_size> class EngineBuffer {
+public:
+  // Bytes taken from the shared RAM, rounded up to the allocator's alignment.
+  static constexpr size_t kSharedRamSize =
+      kSharedEngineRam ? (sizeof(T) * buffer_size + 3) & ~size_t{3} : 0;
+
+  void Init(stmlib::BufferAllocator *allocator) {
+#ifdef PLAITS_SHARED_ENGINE_RAM
+    data_ = allocator->Allocate<T>(buffer_size);
+#endif // PLAITS_SHARED_ENGINE_RAM
+  }
+
+  inline T *data() { return &data_[0]; }
+  inline const T *data() const { return &data_[0]; }
+  inline T &operator[](size_t i) { return data_[i]; }
+  inline const T &operator[](size_t i) const { return data_[i]; }
+
+  inline void fill(T value) { std::fill(data(), data() + buffer_size, value); }
+
+  static constexpr size_t size() { return buffer_size; }
+
+private:
+#ifdef PLAITS_SHARED_ENGINE_RAM
+  T *data_{};
+#else
+  std::array<T, buffer_size> data_{};
+#endif // PLAITS_SHARED_ENGINE_RAM
+};
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_ENGINE_ENGINE_BUFFER_H_
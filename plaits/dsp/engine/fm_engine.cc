@@ -47,6 +47,9 @@ void FMEngine::Init(BufferAllocator* allocator) {
   previous_amount_ = 0.0f;
   previous_feedback_ = 0.0f;
   previous_sample_ = 0.0f;
+  
+  sub_fir_ = 0.0f;
+  carrier_fir_ = 0.0f;
 }
 
 void FMEngine::Reset() {
@@ -69,7 +72,7 @@ void FMEngine::Render(
       128.0f);
   
   float modulator_note = note + ratio;
-  float target_modulator_frequency = NoteToFrequency(modulator_note);
+  float target_modulator_frequency = NoteToInc(modulator_note);
   CONSTRAIN(target_modulator_frequency, 0.0f, 0.5f);
 
   // Reduce the maximum FM index for high pitched notes, to prevent aliasing.
@@ -78,7 +81,7 @@ void FMEngine::Render(
   hf_taming *= hf_taming;
   
   ParameterInterpolator carrier_frequency(
-      &previous_carrier_frequency_, NoteToFrequency(note), size);
+      &previous_carrier_frequency_, NoteToInc(note), size);
   ParameterInterpolator modulator_frequency(
       &previous_modulator_frequency_, target_modulator_frequency, size);
   ParameterInterpolator amount_modulation(
@@ -91,7 +94,7 @@ void FMEngine::Render(
   Downsampler carrier_downsampler(&carrier_fir_);
   Downsampler sub_downsampler(&sub_fir_);
   
-  while (size--) {
+  for (size_t i = 0; i < size; ++i) {
     const float max_uint32 = 4294967296.0f;
     const float amount = amount_modulation.Next();
     const float feedback = feedback_modulation.Next();
@@ -33,15 +33,15 @@
 
 namespace plaits {
   
-class FMEngine : public Engine {
+class FMEngine {
  public:
   FMEngine() { }
   ~FMEngine() { }
   
-  virtual void Init(stmlib::BufferAllocator* allocator);
-  virtual void Reset();
-  virtual void LoadUserData(const uint8_t* user_data) { }
-  virtual void Render(const EngineParameters& parameters,
+  void Init(stmlib::BufferAllocator* allocator);
+  void Reset();
+  void LoadUserData(const uint8_t* user_data) { }
+  void Render(const EngineParameters& parameters,
       float* out,
       float* aux,
       size_t size,
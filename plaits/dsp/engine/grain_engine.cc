@@ -37,7 +37,7 @@ using namespace std;
 using namespace stmlib;
 
 void GrainEngine::Render(const EngineParameters &parameters, float *out,
-                         float *aux, size_t size) {
+                         float *aux, size_t size, bool *already_enveloped) {
   const float root = parameters.note;
   const float f0 = NoteToInc(root);
 
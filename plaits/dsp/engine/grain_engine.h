@@ -40,9 +40,10 @@ namespace plaits {
 
 class GrainEngine {
 public:
+  void Reset() {}
   void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
-              size_t size);
+              size_t size, bool *already_enveloped);
 
 private:
   std::array<GrainletOscillator, 2> grainlet_{};
@@ -36,7 +36,7 @@ using namespace stmlib;
 void HiHatEngine::Reset() {}
 
 void HiHatEngine::Render(const EngineParameters &parameters, float *out,
-                         float *aux, size_t size) {
+                         float *aux, size_t size, bool *already_enveloped) {
   const float f0 = NoteToInc(parameters.note);
 
   hi_hat_1_.Render(parameters.trigger & TRIGGER_UNPATCHED,
@@ -41,7 +41,7 @@ public:
   void Reset();
   void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
-              size_t size);
+              size_t size, bool *already_enveloped);
 
 private:
   HiHat<SquareNoise, SwingVCA, true, false> hi_hat_1_{};
@@ -37,9 +37,17 @@ namespace plaits {
 
 class ModalEngine {
 public:
+  void Reset() {}
+  void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
               size_t size, bool *already_enveloped);
 
+  // Caps the number of partials of the resonator (see Resonator).
+  void set_max_num_modes(int max_num_modes) {
+    voice_.set_max_num_modes(max_num_modes);
+  }
+  inline int max_num_modes() const { return voice_.max_num_modes(); }
+
 private:
   ModalVoice voice_{};
   std::array<float, kMaxBlockSize> temp_buffer_{};
@@ -29,6 +29,7 @@
 #include "plaits/dsp/engine/noise_engine.h"
 
 #include "stmlib/dsp/parameter_interpolator.h"
+#include "stmlib/dsp/units.h"
 
 namespace plaits {
 
@@ -47,7 +48,7 @@ void NoiseEngine::Init(BufferAllocator* allocator) {
   previous_q_ = 0.0f;
   previous_mode_ = 0.0f;
 
-  temp_buffer_ = allocator->Allocate<float>(kMaxBlockSize);
+  temp_buffer_.Init(allocator);
 }
 
 void NoiseEngine::Reset() {
@@ -60,18 +61,18 @@ void NoiseEngine::Render(
     float* aux,
     size_t size,
     bool* already_enveloped) {
-  const float f0 = NoteToFrequency(parameters.note);
-  const float f1 = NoteToFrequency(
+  const float f0 = NoteToInc(parameters.note);
+  const float f1 = NoteToInc(
       parameters.note + parameters.harmonics * 48.0f - 24.0f);
   const float clock_lowest_note = parameters.trigger & TRIGGER_UNPATCHED
       ? 0.0f
       : -24.0f;
-  const float clock_f = NoteToFrequency(
+  const float clock_f = NoteToInc(
       parameters.timbre * (128.0f - clock_lowest_note) + clock_lowest_note);
   const float q = 0.5f * SemitonesToRatio(parameters.morph * 120.0f);
   const bool sync = parameters.trigger & TRIGGER_RISING_EDGE;
   clocked_noise_[0].Render(sync, clock_f, aux, size);
-  clocked_noise_[1].Render(sync, clock_f * f1 / f0, temp_buffer_, size);
+  clocked_noise_[1].Render(sync, clock_f * f1 / f0, temp_buffer_.data(), size);
   
   ParameterInterpolator f0_modulation(&previous_f0_, f0, size);
   ParameterInterpolator f1_modulation(&previous_f1_, f1, size);
@@ -80,8 +81,8 @@ void NoiseEngine::Render(
       &previous_mode_, parameters.harmonics, size);
   
   const float* in_1 = aux;
-  const float* in_2 = temp_buffer_;
-  while (size--) {
+  const float* in_2 = temp_buffer_.data();
+  for (size_t i = 0; i < size; ++i) {
     const float f0 = f0_modulation.Next();
     const float f1 = f1_modulation.Next();
     const float q = q_modulation.Next();
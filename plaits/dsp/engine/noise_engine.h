@@ -32,19 +32,25 @@
 #include "stmlib/dsp/filter.h"
 
 #include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/engine/engine_buffer.h"
 #include "plaits/dsp/noise/clocked_noise.h"
 
 namespace plaits {
 
-class NoiseEngine : public Engine {
+class NoiseEngine {
  public:
   NoiseEngine() { }
   ~NoiseEngine() { }
   
-  virtual void Init(stmlib::BufferAllocator* allocator);
-  virtual void Reset();
-  virtual void LoadUserData(const uint8_t* user_data) { }
-  virtual void Render(const EngineParameters& parameters,
+  using TempBuffer = EngineBuffer<float, kMaxBlockSize>;
+  
+  // Bytes carved from the shared RAM by Init().
+  static const size_t kSharedRamSize = TempBuffer::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator* allocator);
+  void Reset();
+  void LoadUserData(const uint8_t* user_data) { }
+  void Render(const EngineParameters& parameters,
       float* out,
       float* aux,
       size_t size,
@@ -60,7 +66,7 @@ class NoiseEngine : public Engine {
   float previous_q_;
   float previous_mode_;
   
-  float* temp_buffer_;
+  TempBuffer temp_buffer_;
   
   DISALLOW_COPY_AND_ASSIGN(NoiseEngine);
 };
@@ -34,12 +34,15 @@ namespace plaits {
 
 using namespace stmlib;
 
-void ParticleEngine::Init() { diffuser_.Init(); }
+void ParticleEngine::Init(BufferAllocator *allocator) {
+  diffuser_buffer_.Init(allocator);
+  diffuser_.Init(diffuser_buffer_.data());
+}
 
 void ParticleEngine::Reset() { diffuser_.Reset(); }
 
 void ParticleEngine::Render(const EngineParameters &parameters, float *out,
-                            size_t size) {
+                            float *aux, size_t size, bool *already_enveloped) {
   const float f0 = NoteToInc(parameters.note);
   const float density_sqrt =
       NoteToInc(60.0f + parameters.timbre * parameters.timbre * 72.0f);
@@ -54,10 +57,14 @@ void ParticleEngine::Render(const EngineParameters &parameters, float *out,
   const float diffusion = parameters.morph < 0.5f ? raw_diffusion : 0.0f;
   const bool sync = parameters.trigger & TRIGGER_RISING_EDGE;
 
+  std::fill(&out[0], &out[size], 0.0f);
   for (int i = 0; i < kNumParticles; ++i) {
     particle_[i].Render(sync, density, gain, f0, spread, q, out, size);
   }
 
+  // The raw particles are sent to the aux output.
+  std::copy(&out[0], &out[size], &aux[0]);
+
   post_filter_.set_f_q<FREQUENCY_DIRTY>(std::min(f0, 0.49f), 0.5f);
   post_filter_.Process<FILTER_MODE_LOW_PASS>(out, out, size);
 
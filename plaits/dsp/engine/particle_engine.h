@@ -30,6 +30,7 @@
 #define PLAITS_DSP_ENGINE_PARTICLE_ENGINE_H_
 
 #include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/engine/engine_buffer.h"
 #include "plaits/dsp/fx/diffuser.h"
 #include "plaits/dsp/noise/particle.h"
 
@@ -39,11 +40,17 @@ inline constexpr auto kNumParticles = 6;
 
 class ParticleEngine {
 public:
-  void Init();
+  using DiffuserBuffer = EngineBuffer<uint16_t, Diffuser::kBufferSize>;
+  static constexpr size_t kSharedRamSize = DiffuserBuffer::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator *allocator);
   void Reset();
-  void Render(const EngineParameters &parameters, float *out, size_t size);
+  void LoadUserData(const uint8_t *user_data) {}
+  void Render(const EngineParameters &parameters, float *out, float *aux,
+              size_t size, bool *already_enveloped);
 
 private:
+  DiffuserBuffer diffuser_buffer_{};
   Diffuser diffuser_{};
   std::array<Particle, kNumParticles> particle_{};
   stmlib::Svf post_filter_{};
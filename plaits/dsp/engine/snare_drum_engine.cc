@@ -35,8 +35,11 @@ namespace plaits {
 using namespace std;
 using namespace stmlib;
 
-void SnareDrumEngine::Render(const EngineParameters &parameters, float *out,
-                             float *aux, size_t size) {
+template <size_t block_size>
+void SnareDrumEngine::RenderBlock(const EngineParameters &parameters,
+                                  float *out, float *aux, size_t runtime_size,
+                                  bool *already_enveloped) {
+  const size_t size = block_size ? block_size : runtime_size;
   const float f0 = NoteToInc(parameters.note);
 
   analog_snare_drum_.Render(parameters.trigger & TRIGGER_UNPATCHED,
@@ -50,4 +53,12 @@ void SnareDrumEngine::Render(const EngineParameters &parameters, float *out,
       parameters.timbre, parameters.morph, parameters.harmonics, aux, size);
 }
 
+void SnareDrumEngine::Render(const EngineParameters &parameters, float *out,
+                             float *aux, size_t size, bool *already_enveloped) {
+  DispatchBlockSize(size, [&](auto block_size) {
+    RenderBlock<decltype(block_size)::value>(parameters, out, aux, size,
+                                             already_enveloped);
+  });
+}
+
 } // namespace plaits
@@ -37,11 +37,16 @@ namespace plaits {
 
 class SnareDrumEngine {
 public:
+  void Reset() {}
   void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
-              size_t size);
+              size_t size, bool *already_enveloped);
 
 private:
+  template <size_t block_size>
+  void RenderBlock(const EngineParameters &parameters, float *out, float *aux,
+                   size_t runtime_size, bool *already_enveloped);
+
   AnalogSnareDrum analog_snare_drum_{};
   SyntheticSnareDrum synthetic_snare_drum_{};
 };
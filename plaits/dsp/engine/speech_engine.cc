@@ -50,7 +50,8 @@ void SamSpeechEngine::Init() {
 void LPCSpeechEngine::Reset() {}
 
 void NaiveSpeechEngine::Render(const EngineParameters &parameters, float *out,
-                               float *aux, size_t size) {
+                               float *aux, size_t size,
+                               bool *already_enveloped) {
   const float f0 = NoteToInc(parameters.note);
 
   float blend = parameters.harmonics;
@@ -72,7 +73,8 @@ void NaiveSpeechEngine::Render(const EngineParameters &parameters, float *out,
 }
 
 void SamSpeechEngine::Render(const EngineParameters &parameters, float *out,
-                             float *aux, size_t size) {
+                             float *aux, size_t size,
+                             bool *already_enveloped) {
   const float f0 = NoteToInc(parameters.note);
 
   lpc_speech_synth_controller_.Render(parameters.trigger, f0, 0.0f, 0.0f,
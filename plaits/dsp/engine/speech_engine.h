@@ -42,8 +42,9 @@ class NaiveSpeechEngine {
 public:
   void Init();
   void Reset() {}
+  void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
-              size_t size);
+              size_t size, bool *already_enveloped);
 
 private:
   std::array<std::array<float, kMaxBlockSize>, 2> temp_buffer_;
@@ -55,8 +56,9 @@ class SamSpeechEngine {
 public:
   void Init();
   void Reset() {}
+  void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
-              size_t size);
+              size_t size, bool *already_enveloped);
 
 private:
   std::array<std::array<float, kMaxBlockSize>, 2> temp_buffer_;
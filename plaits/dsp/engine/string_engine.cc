@@ -35,6 +35,11 @@ namespace plaits {
 using namespace std;
 using namespace stmlib;
 
+void StringEngine::Reset() {
+  f0_delay_.Reset();
+  voice_.Reset();
+}
+
 void StringEngine::Render(const EngineParameters &parameters, float *out,
                           float *aux, size_t size, bool *already_enveloped) {
   const float f0_ = NoteToInc(parameters.note);
@@ -36,6 +36,7 @@ namespace plaits {
 
 class StringEngine {
 public:
+  void Reset();
   void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
               size_t size, bool *already_enveloped);
@@ -45,8 +45,11 @@ void SwarmEngine::Reset() {
   }
 }
 
-void SwarmEngine::Render(const EngineParameters &parameters, float *out,
-                         float *aux, size_t size) {
+template <size_t block_size>
+void SwarmEngine::RenderBlock(const EngineParameters &parameters, float *out,
+                              float *aux, size_t runtime_size,
+                              bool *already_enveloped) {
+  const size_t size = block_size ? block_size : runtime_size;
   const float f0 = NoteToInc(parameters.note);
   const float control_rate = static_cast<float>(size);
   const float density =
@@ -69,4 +72,12 @@ void SwarmEngine::Render(const EngineParameters &parameters, float *out,
   }
 }
 
+void SwarmEngine::Render(const EngineParameters &parameters, float *out,
+                         float *aux, size_t size, bool *already_enveloped) {
+  DispatchBlockSize(size, [&](auto block_size) {
+    RenderBlock<decltype(block_size)::value>(parameters, out, aux, size,
+                                             already_enveloped);
+  });
+}
+
 } // namespace plaits
@@ -203,9 +203,13 @@ public:
   void Reset();
   void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
-              size_t size);
+              size_t size, bool *already_enveloped);
 
 private:
+  template <size_t block_size>
+  void RenderBlock(const EngineParameters &parameters, float *out, float *aux,
+                   size_t runtime_size, bool *already_enveloped);
+
   std::array<SwarmVoice, kNumSwarmVoices> swarm_voice_;
 
   DISALLOW_COPY_AND_ASSIGN(SwarmEngine);
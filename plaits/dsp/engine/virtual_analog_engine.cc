@@ -38,16 +38,13 @@ using namespace std;
 using namespace stmlib;
 
 void VirtualAnalogEngine::Init(BufferAllocator* allocator) {
-  primary_.Init();
-  auxiliary_.Init();
   auxiliary_.set_master_phase(0.25f);
-  sync_.Init();
   variable_saw_.Init();
   
   auxiliary_amount_ = 0.0f;
   xmod_amount_ = 0.0f;
   
-  temp_buffer_ = allocator->Allocate<float>(kMaxBlockSize);
+  temp_buffer_.Init(allocator);
 }
 
 void VirtualAnalogEngine::Reset() {
@@ -89,9 +86,9 @@ void VirtualAnalogEngine::Render(
   // OUT = 1 + 2.
   // AUX = 1 + sync 2.
   const float auxiliary_detune = ComputeDetuning(parameters.harmonics);
-  const float primary_f = NoteToFrequency(parameters.note);
-  const float auxiliary_f = NoteToFrequency(parameters.note + auxiliary_detune);
-  const float sync_f = NoteToFrequency(
+  const float primary_f = NoteToInc(parameters.note);
+  const float auxiliary_f = NoteToInc(parameters.note + auxiliary_detune);
+  const float sync_f = NoteToInc(
       parameters.note + parameters.harmonics * 48.0f);
 
   float shape_1 = parameters.timbre * 1.5f;
@@ -106,7 +103,7 @@ void VirtualAnalogEngine::Render(
   float pw_2 = 0.5f + (parameters.morph - 0.66f) * 1.4f;
   CONSTRAIN(pw_2, 0.5f, 0.99f);
   
-  primary_.Render(primary_f, pw_1, shape_1, temp_buffer_, size);
+  primary_.Render(primary_f, pw_1, shape_1, temp_buffer_.data(), size);
   auxiliary_.Render(auxiliary_f, pw_2, shape_2, aux, size);
   for (size_t i = 0; i < size; ++i) {
     out[i] = (aux[i] + temp_buffer_[i]) * 0.5f;
@@ -131,8 +128,8 @@ void VirtualAnalogEngine::Render(
   const float squashed_xmod_amount = xmod_amount * (2.0f - xmod_amount);
 
   const float auxiliary_detune = ComputeDetuning(parameters.harmonics);
-  const float primary_f = NoteToFrequency(parameters.note);
-  const float auxiliary_f = NoteToFrequency(parameters.note + auxiliary_detune);
+  const float primary_f = NoteToInc(parameters.note);
+  const float auxiliary_f = NoteToInc(parameters.note + auxiliary_detune);
   const float sync_f = primary_f * SemitonesToRatio(
       xmod_amount * (auxiliary_detune + 36.0f));
 
@@ -172,11 +169,11 @@ void VirtualAnalogEngine::Render(
   
   const float sync_amount = parameters.timbre * parameters.timbre;
   const float auxiliary_detune = ComputeDetuning(parameters.harmonics);
-  const float primary_f = NoteToFrequency(parameters.note);
-  const float auxiliary_f = NoteToFrequency(parameters.note + auxiliary_detune);
-  const float primary_sync_f = NoteToFrequency(
+  const float primary_f = NoteToInc(parameters.note);
+  const float auxiliary_f = NoteToInc(parameters.note + auxiliary_detune);
+  const float primary_sync_f = NoteToInc(
       parameters.note + sync_amount * 48.0f);
-  const float auxiliary_sync_f = NoteToFrequency(
+  const float auxiliary_sync_f = NoteToInc(
       parameters.note + auxiliary_detune + sync_amount * 48.0f);
 
   float shape = parameters.morph * 1.5f;
@@ -214,11 +211,11 @@ void VirtualAnalogEngine::Render(
   float saw_gain = 8.0f * (1.0f - parameters.morph);
   CONSTRAIN(saw_gain, 0.02f, 1.0f);
   
-  const float square_sync_f = NoteToFrequency(
+  const float square_sync_f = NoteToInc(
       parameters.note + square_sync_ratio);
   
   sync_.Render(
-      primary_f, square_sync_f, square_pw, 1.0f, temp_buffer_, size);
+      primary_f, square_sync_f, square_pw, 1.0f, temp_buffer_.data(), size);
   variable_saw_.Render(auxiliary_f, saw_pw, saw_shape, out, size);
   
   float norm = 1.0f / (std::max(square_gain, saw_gain));
@@ -30,6 +30,7 @@
 #define PLAITS_DSP_ENGINE_VIRTUAL_ANALOG_ENGINE_H_
 
 #include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/engine/engine_buffer.h"
 #include "plaits/dsp/oscillator/variable_saw_oscillator.h"
 #include "plaits/dsp/oscillator/variable_shape_oscillator.h"
 
@@ -37,15 +38,20 @@
 
 namespace plaits {
   
-class VirtualAnalogEngine : public Engine {
+class VirtualAnalogEngine {
  public:
   VirtualAnalogEngine() { }
   ~VirtualAnalogEngine() { }
   
-  virtual void Init(stmlib::BufferAllocator* allocator);
-  virtual void Reset();
-  virtual void LoadUserData(const uint8_t* user_data) { }
-  virtual void Render(const EngineParameters& parameters,
+  using TempBuffer = EngineBuffer<float, kMaxBlockSize>;
+  
+  // Bytes carved from the shared RAM by Init().
+  static const size_t kSharedRamSize = TempBuffer::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator* allocator);
+  void Reset();
+  void LoadUserData(const uint8_t* user_data) { }
+  void Render(const EngineParameters& parameters,
       float* out,
       float* aux,
       size_t size,
@@ -62,7 +68,7 @@ class VirtualAnalogEngine : public Engine {
 
   float auxiliary_amount_;
   float xmod_amount_;
-  float* temp_buffer_;
+  TempBuffer temp_buffer_;
   
   DISALLOW_COPY_AND_ASSIGN(VirtualAnalogEngine);
 };
@@ -42,8 +42,6 @@ using namespace std;
 using namespace stmlib;
 
 void WaveshapingEngine::Init(BufferAllocator* allocator) {
-  slope_.Init();
-  triangle_.Init();
   previous_shape_ = 0.0f;
   previous_wavefolder_gain_ = 0.0f;
   previous_overtone_gain_ = 0.0f;
@@ -69,7 +67,7 @@ void WaveshapingEngine::Render(
     bool* already_enveloped) {
   const float root = parameters.note;
   
-  const float f0 = NoteToFrequency(root);
+  const float f0 = NoteToInc(root);
   const float pw = parameters.morph * 0.45f + 0.5f;
   
   // Start from bandlimited slope signal.
@@ -37,8 +37,7 @@ namespace plaits {
 using namespace std;
 using namespace stmlib;
 
-const int kNumBanks = 4;
-const int kNumWavesPerBank = 64;
+const int kNumBanks = kNumWavetableBanks;
 const int kNumWaves = 192;
 const int kNumCustomWaves = 15;
 
@@ -63,7 +62,7 @@ void WavetableEngine::Init(BufferAllocator* allocator) {
 
   diff_out_.Init();
   
-  wave_map_ = allocator->Allocate<const int16_t*>(kNumWavesPerBank);
+  wave_map_.Init(allocator);
 }
 
 void WavetableEngine::Reset() {
@@ -116,7 +115,7 @@ void WavetableEngine::Render(
     float* aux,
     size_t size,
     bool* already_enveloped) {
-  const float f0 = NoteToFrequency(parameters.note);
+  const float f0 = NoteToInc(parameters.note);
   
   ONE_POLE(x_pre_lp_, parameters.timbre * 6.9999f, 0.2f);
   ONE_POLE(y_pre_lp_, parameters.morph * 6.9999f, 0.2f);
@@ -147,7 +146,7 @@ void WavetableEngine::Render(
 
   ParameterInterpolator f0_modulation(&previous_f0_, f0, size);
   
-  while (size--) {
+  for (size_t i = 0; i < size; ++i) {
     const float f0 = f0_modulation.Next();
     
     const float gain = (1.0f / (f0 * 131072.0f)) * (0.95f - f0);
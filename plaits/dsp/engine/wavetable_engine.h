@@ -30,19 +30,29 @@
 #define PLAITS_DSP_ENGINE_WAVETABLE_ENGINE_H_
 
 #include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/engine/engine_buffer.h"
 #include "plaits/dsp/oscillator/wavetable_oscillator.h"
 
 namespace plaits {
 
-class WavetableEngine : public Engine {
+const int kNumWavesPerBank = 64;
+const int kNumWavetableBanks = 4;
+
+class WavetableEngine {
  public:
   WavetableEngine() { }
   ~WavetableEngine() { }
   
-  virtual void Init(stmlib::BufferAllocator* allocator);
-  virtual void Reset();
-  virtual void LoadUserData(const uint8_t* user_data);
-  virtual void Render(const EngineParameters& parameters,
+  using WaveMap = EngineBuffer<
+      const int16_t*, kNumWavetableBanks * kNumWavesPerBank>;
+  
+  // Bytes carved from the shared RAM by Init().
+  static const size_t kSharedRamSize = WaveMap::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator* allocator);
+  void Reset();
+  void LoadUserData(const uint8_t* user_data);
+  void Render(const EngineParameters& parameters,
       float* out,
       float* aux,
       size_t size,
@@ -68,7 +78,7 @@ class WavetableEngine : public Engine {
   
   // Maps a (bank, X, Y) coordinate to a waveform index.
   // This allows all waveforms to be reshuffled by the user to create new maps.
-  const int16_t** wave_map_;
+  WaveMap wave_map_;
   
   Differentiator diff_out_;
   
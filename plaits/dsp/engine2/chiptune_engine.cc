@@ -35,8 +35,8 @@ namespace plaits {
 using namespace std;
 using namespace stmlib;
 
-void ChiptuneEngine::RenderChord(const EngineParameters &parameters, float *out,
-                                 float *aux, size_t size) {
+void ChiptuneEngine::Render(const EngineParameters &parameters, float *out,
+                            float *aux, size_t size, bool *already_enveloped) {
   const float f0 = NoteToInc(parameters.note);
   const float shape = parameters.morph * 0.995f;
 
@@ -37,9 +37,10 @@ namespace plaits {
 
 class ChiptuneEngine {
 public:
+  void Reset() {}
   void LoadUserData(const uint8_t *user_data) {}
-  void RenderChord(const EngineParameters &parameters, float *out, float *aux,
-                   size_t size);
+  void Render(const EngineParameters &parameters, float *out, float *aux,
+              size_t size, bool *already_enveloped);
 
 private:
   std::array<SuperSquareOscillator, kChordNumVoices> voice_{};
@@ -0,0 +1,238 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Voices of the polyphonic FM engines: allocation, LFOs, and rendering of the
+// voices sharing an algorithm in SIMD lanes.
+
+#ifndef PLAITS_DSP_ENGINE_FM_VOICE_POOL_H_
+#define PLAITS_DSP_ENGINE_FM_VOICE_POOL_H_
+
+#include "plaits/dsp/dsp.h"
+
+#include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/engine/engine_buffer.h"
+#include "plaits/dsp/fm/algorithms.h"
+#include "plaits/dsp/fm/lfo_bank.h"
+#include "plaits/dsp/fm/patch.h"
+#include "plaits/dsp/fm/voice.h"
+#include "plaits/dsp/simd.h"
+#include <algorithm>
+#include <array>
+
+namespace plaits {
+
+template <int num_operators> class FMVoice {
+public:
+  void Init(const fm::Algorithms<num_operators> *algorithms) {
+    voice_.Init(algorithms);
+  }
+  void LoadPatch(const fm::Patch *patch,
+                 const typename fm::Voice<num_operators>::PatchSetup *setup) {
+    voice_.SetPatch(patch, setup);
+  }
+
+  inline const fm::Patch *patch() const { return voice_.patch(); }
+  inline bool idle() const { return !parameters_.gate && voice_.idle(); }
+
+  inline fm::Voice<num_operators> *mutable_voice() { return &voice_; }
+  inline typename fm::Voice<num_operators>::Parameters *mutable_parameters() {
+    return &parameters_;
+  }
+  inline const typename fm::Voice<num_operators>::Parameters &
+  parameters() const {
+    return parameters_;
+  }
+
+  inline void set_modulations(float pitch_mod, float amp_mod) {
+    parameters_.pitch_mod = pitch_mod;
+    parameters_.amp_mod = amp_mod;
+  }
+
+private:
+  fm::Voice<num_operators> voice_;
+  typename fm::Voice<num_operators>::Parameters parameters_{};
+};
+
+template <int num_operators, int num_voices> class FMVoicePool {
+  // Voices sharing an algorithm are rendered simd::kNumLanes at a time.
+  using LanesBuffer = EngineBuffer<float, kMaxBlockSize * simd::kNumLanes>;
+
+public:
+  using Voice = fm::Voice<num_operators>;
+  using PatchSetup = typename Voice::PatchSetup;
+
+  static constexpr size_t kSharedRamSize = LanesBuffer::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator *allocator, const fm::Patch *patch,
+            const PatchSetup *setup) {
+    lanes_buffer_.Init(allocator);
+    for (int i = 0; i < num_voices; ++i) {
+      voice_[i].Init(&algorithms_);
+    }
+    SetAllPatches(patch, setup);
+    Reset();
+  }
+
+  // Switches all the voices to patch. The LFOs are keyed by patch address, so
+  // this must be called when the patches played so far are overwritten.
+  void SetAllPatches(const fm::Patch *patch, const PatchSetup *setup) {
+    lfos_.Init(0);
+    lfo_.fill(-1);
+    for (int i = 0; i < num_voices; ++i) {
+      SetPatch(i, patch, setup);
+    }
+  }
+
+  void Reset() {
+    age_.fill(0);
+    num_notes_ = 0;
+  }
+
+  // Picks the voice for a new note among the first polyphony ones: an idle
+  // voice, or else the oldest released voice, or else the oldest voice.
+  int Allocate(int polyphony) {
+    int idle = -1;
+    int released = -1;
+    int oldest = 0;
+    for (int i = 0; i < polyphony; ++i) {
+      if (voice_[i].idle()) {
+        if (idle == -1 || age_[i] < age_[idle]) {
+          idle = i;
+        }
+      } else if (!voice_[i].parameters().gate) {
+        if (released == -1 || age_[i] < age_[released]) {
+          released = i;
+        }
+      }
+      if (age_[i] < age_[oldest]) {
+        oldest = i;
+      }
+    }
+    const int voice =
+        idle != -1 ? idle : (released != -1 ? released : oldest);
+    age_[voice] = ++num_notes_;
+    return voice;
+  }
+
+  // Switches the patch of a voice, and the LFO it follows.
+  void SetPatch(int voice, const fm::Patch *patch, const PatchSetup *setup) {
+    if (lfo_[voice] != -1) {
+      lfos_.Release(lfo_[voice]);
+    }
+    voice_[voice].LoadPatch(patch, setup);
+    lfo_[voice] = lfos_.Acquire(patch);
+  }
+
+  // On note on, once the voice has its patch.
+  void Trigger(int voice) { lfos_.Reset(lfo_[voice]); }
+
+  // Renders all the voices, with the note, velocity and gate of parameters
+  // applied to active_voice. Overwrites out.
+  void Render(const EngineParameters &parameters, int active_voice,
+              float *out, size_t size) {
+    auto p = voice_[active_voice].mutable_parameters();
+    p->note = parameters.note;
+    p->velocity = parameters.accent;
+    p->envelope_control = parameters.morph;
+    lfos_.Step(float(size));
+
+    for (int i = 0; i < num_voices; ++i) {
+      auto p = voice_[i].mutable_parameters();
+      p->brightness = parameters.timbre;
+      p->sustain = false;
+      p->gate = (parameters.trigger & TRIGGER_HIGH) && (i == active_voice);
+      voice_[i].set_modulations(lfos_.pitch_mod(lfo_[i]),
+                                lfos_.amp_mod(lfo_[i]));
+    }
+
+    std::fill(&out[0], &out[size], 0.0f);
+    RenderVoices(out, size);
+  }
+
+  inline const fm::Patch *patch(int voice) const {
+    return voice_[voice].patch();
+  }
+
+  int num_active_voices() const {
+    int n = 0;
+    for (int i = 0; i < num_voices; ++i) {
+      n += !voice_[i].idle();
+    }
+    return n;
+  }
+
+private:
+  void RenderVoices(float *out, size_t size) {
+    const size_t lanes = simd::kNumLanes;
+    uint32_t pending = 0;
+    for (int i = 0; i < num_voices; ++i) {
+      if (!voice_[i].idle()) {
+        pending |= 1 << i;
+      }
+    }
+
+    // Group the voices by algorithm, and render each group in SIMD lanes.
+    for (int first = 0; first < num_voices; ++first) {
+      if (!(pending & (1 << first))) {
+        continue;
+      }
+      const int algorithm = voice_[first].patch()->algorithm;
+
+      Voice *voices[lanes] = {};
+      typename Voice::Parameters parameters[lanes];
+      float *outs[lanes];
+      size_t n = 0;
+      for (int i = first; i < num_voices && n < lanes; ++i) {
+        if ((pending & (1 << i)) && voice_[i].patch()->algorithm == algorithm) {
+          voices[n] = voice_[i].mutable_voice();
+          parameters[n] = voice_[i].parameters();
+          pending &= ~(1 << i);
+          ++n;
+        }
+      }
+      std::fill(&outs[0], &outs[lanes], out);
+
+      if (n == 1) {
+        voices[0]->Render(parameters[0], out, size);
+      } else {
+        Voice::RenderLanes(voices, parameters, lanes_buffer_.data(), outs,
+                           size);
+      }
+    }
+  }
+
+  fm::Algorithms<num_operators> algorithms_;
+  std::array<FMVoice<num_operators>, num_voices> voice_{};
+  // Note-on order of the voices, for stealing.
+  std::array<uint32_t, num_voices> age_{};
+  // One LFO per patch being played, shared by the voices playing it.
+  fm::LfoBank<num_voices> lfos_;
+  std::array<int, num_voices> lfo_{};
+  LanesBuffer lanes_buffer_{};
+  uint32_t num_notes_{};
+};
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_ENGINE_FM_VOICE_POOL_H_
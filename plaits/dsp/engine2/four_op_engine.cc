@@ -0,0 +1,86 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// 4-operator FM synth, playing DX21/DX100/TX81Z voices.
+
+#include "plaits/dsp/engine2/four_op_engine.h"
+
+#include <algorithm>
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/fm_patch_vmem.hh"
+
+namespace plaits {
+
+using namespace fm;
+using namespace std;
+using namespace stmlib;
+
+static constexpr FourOpEngine::Bank built_in_bank = []() {
+  FourOpEngine::Bank out{};
+  out.Load(vmem_bank_0, sizeof(vmem_bank_0) / Patch::VMEM_SIZE);
+  return out;
+}();
+
+void FourOpEngine::Init(BufferAllocator *allocator) {
+  bank_ = &built_in_bank;
+  voices_.Init(allocator, &bank_->patches[0], &bank_->setups[0]);
+  polyphony_ = kDefaultFourOpPolyphony;
+  Reset();
+}
+
+void FourOpEngine::Reset() {
+  voices_.Reset();
+  active_voice_ = 0;
+}
+
+void FourOpEngine::LoadUserData(const uint8_t *user_data) {
+  if (user_data && user_bank_) {
+    user_bank_->Load(user_data);
+    bank_ = user_bank_;
+  } else {
+    bank_ = &built_in_bank;
+  }
+  voices_.SetAllPatches(&bank_->patches[0], &bank_->setups[0]);
+}
+
+void FourOpEngine::Render(const EngineParameters &parameters, float *out,
+                          float *aux, size_t size, bool *already_enveloped) {
+  if (parameters.trigger & TRIGGER_RISING_EDGE) {
+    active_voice_ = voices_.Allocate(polyphony_);
+    const size_t index =
+        static_cast<unsigned>(parameters.harmonics) % bank_->size;
+    voices_.SetPatch(active_voice_, &bank_->patches[index],
+                     &bank_->setups[index]);
+    voices_.Trigger(active_voice_);
+  }
+  voices_.Render(parameters, active_voice_, out, size);
+
+  for (size_t i = 0; i < size; ++i) {
+    out[i] = SoftClip(out[i] * 0.25f);
+  }
+  copy(&out[0], &out[size], &aux[0]);
+}
+
+} // namespace plaits
@@ -0,0 +1,114 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// 4-operator FM synth, playing DX21/DX100/TX81Z voices.
+
+#ifndef PLAITS_DSP_ENGINE_FOUR_OP_ENGINE_H_
+#define PLAITS_DSP_ENGINE_FOUR_OP_ENGINE_H_
+
+#include "plaits/dsp/dsp.h"
+
+#include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/engine2/fm_voice_pool.h"
+#include "plaits/dsp/fm/patch.h"
+#include "plaits/dsp/fm/voice.h"
+#include <algorithm>
+#include <array>
+
+namespace plaits {
+
+// A 4-operator voice costs about half as much as a 6-operator one, so the
+// engine can afford twice as many.
+const int kMaxFourOpVoices = 16;
+const int kDefaultFourOpPolyphony = 4;
+
+class FourOpEngine {
+  using VoicePool = FMVoicePool<4, kMaxFourOpVoices>;
+
+public:
+  // Size of a VMEM bulk dump, without the SysEx header and footer.
+  static constexpr size_t kNumPatches = 32;
+  static constexpr size_t kBankSize = kNumPatches * fm::Patch::VMEM_SIZE;
+
+  static constexpr size_t kSharedRamSize = VoicePool::kSharedRamSize;
+
+  // A VMEM bank, unpacked and set up so that switching patches costs nothing
+  // at run time. At about 16 kB, it is too large to embed in every instance:
+  // the built-in bank is shared read-only data, and the storage for a user
+  // bank is owned by the caller.
+  struct Bank {
+    std::array<fm::Patch, kNumPatches> patches;
+    std::array<VoicePool::PatchSetup, kNumPatches> setups;
+    size_t size;
+
+    // Loads a 32-voice VMEM bank, with or without its SysEx header (F0 43 0n
+    // 04 20 00).
+    constexpr void Load(const uint8_t *data, size_t num_patches = kNumPatches) {
+      if (data[0] == 0xf0 && data[1] == 0x43 && data[3] == 0x04) {
+        data += 6;
+      }
+      size = num_patches;
+      for (size_t i = 0; i < size; ++i) {
+        patches[i].UnpackVMEM(data + i * fm::Patch::VMEM_SIZE);
+        setups[i] = VoicePool::PatchSetup::Compute(patches[i]);
+      }
+    }
+  };
+
+  void Init(stmlib::BufferAllocator *allocator);
+  void Reset();
+
+  // Storage for the bank loaded by LoadUserData(). Without it, user data is
+  // ignored and the engine plays the built-in bank.
+  void set_user_bank(Bank *bank) { user_bank_ = bank; }
+
+  // Loads a VMEM bank into the user bank storage, or selects the built-in
+  // bank when user_data is NULL. The patches are unpacked and set up here, so
+  // this must not be called from the audio callback while the engine is
+  // playing.
+  void LoadUserData(const uint8_t *user_data);
+  void Render(const EngineParameters &parameters, float *out, float *aux,
+              size_t size, bool *already_enveloped);
+
+  // Voices above the new polyphony are not retriggered, but finish their
+  // release.
+  void set_polyphony(int polyphony) {
+    polyphony_ = std::clamp(polyphony, 1, kMaxFourOpVoices);
+  }
+  inline int polyphony() const { return polyphony_; }
+  inline int num_active_voices() const { return voices_.num_active_voices(); }
+  inline size_t num_patches() const { return bank_->size; }
+
+private:
+  const Bank *bank_{};
+  Bank *user_bank_{};
+
+  VoicePool voices_;
+  int polyphony_{kDefaultFourOpPolyphony};
+  int active_voice_{};
+};
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_ENGINE_FOUR_OP_ENGINE_H_
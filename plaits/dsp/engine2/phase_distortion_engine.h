@@ -39,12 +39,12 @@ namespace plaits {
 
 class PhaseDistortionEngine {
 public:
+  void Reset() {}
   void LoadUserData(const uint8_t *user_data) {}
-  void RenderOut(const EngineParameters &parameters, float *out, size_t size);
-  void RenderAux(const EngineParameters &parameters, float *aux, size_t size);
+  void Render(const EngineParameters &parameters, float *out, float *aux,
+              size_t size, bool *already_enveloped);
 
 private:
-  void RenderBase(const EngineParameters &parameters, size_t size);
   VariableShapeOscillator shaper_{};
   VariableShapeOscillator modulator_{};
   std::array<float, kMaxBlockSize * 4> temp_buffer_{};
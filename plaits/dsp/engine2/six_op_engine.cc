@@ -33,7 +33,6 @@
 
 #include "plaits/dsp/dsp.h"
 #include "plaits/fm_patch_sysex.hh"
-#include "synth/block.hh"
 
 namespace plaits {
 
@@ -41,17 +40,6 @@ using namespace fm;
 using namespace std;
 using namespace stmlib;
 
-void FMVoice::Init(fm::Algorithms<6> *algorithms) { voice_.Init(algorithms); }
-
-void FMVoice::Render(float *buffer, size_t size) {
-  voice_.Render(parameters_, buffer, size);
-}
-
-void FMVoice::LoadPatch(const fm::Patch *patch) {
-  voice_.SetPatch(patch);
-  lfo_.Set(patch->modulations);
-}
-
 using PatchBank = std::array<fm::Patch, kNumPatchesPerBank>;
 using Banks = std::array<PatchBank, 3>;
 
@@ -65,64 +53,85 @@ static constexpr Banks bank = []() {
   return out;
 }();
 
-void SixOpEngine::Init() {
-  algorithms_.Init();
-  for (int i = 0; i < kNumSixOpVoices; ++i) {
-    voice_[i].Init(&algorithms_);
+// Everything fm::Voice derives from the patches, so that switching patches
+// costs nothing at run time.
+using SetupBank = std::array<fm::Voice<6>::PatchSetup, kNumPatchesPerBank>;
+using Setups = std::array<SetupBank, 3>;
+
+static constexpr Setups setups = []() {
+  Setups out{};
+  for (auto i = 0u; i < out.size(); ++i) {
+    for (auto p = 0u; p < kNumPatchesPerBank; ++p) {
+      out[i][p] = fm::Voice<6>::PatchSetup::Compute(bank[i][p]);
+    }
   }
-  voice_[0].LoadPatch(&bank[0][0]);
-  voice_[1].LoadPatch(&bank[0][0]);
-}
+  return out;
+}();
 
-void SixOpEngine::Render(const EngineParameters &parameters,
-                         ToySynth::Synth::Bus &bus) {
-  const auto patch_p = static_cast<unsigned>(parameters.harmonics);
-  const auto patch_bank = patch_p / kNumPatchesPerBank;
-  const auto patch_index = patch_p % kNumPatchesPerBank;
+void SixOpEngine::Init(BufferAllocator *allocator) {
+  voices_.Init(allocator, &bank[0][0], &setups[0][0]);
+  library_patch_.fill(-1);
+  polyphony_ = kDefaultSixOpPolyphony;
+  Reset();
+}
 
-  if (parameters.trigger & TRIGGER_RISING_EDGE) {
-    active_voice_ = (active_voice_ + 1) % kNumSixOpVoices;
-    voice_[active_voice_].LoadPatch(&bank[patch_bank][patch_index]);
-    voice_[active_voice_].mutable_lfo()->Reset();
-  }
+void SixOpEngine::Reset() {
+  voices_.Reset();
+  active_voice_ = 0;
+}
 
-  auto p = voice_[active_voice_].mutable_parameters();
-  p->note = parameters.note;
-  p->velocity = parameters.accent;
-  p->envelope_control = parameters.morph;
-  voice_[active_voice_].mutable_lfo()->Step(float(bus.size()));
-
-  for (int i = 0; i < kNumSixOpVoices; ++i) {
-    auto p = voice_[i].mutable_parameters();
-    p->brightness = parameters.timbre;
-    p->sustain = false;
-    p->gate = (parameters.trigger & TRIGGER_HIGH) && (i == active_voice_);
-    if (voice_[i].patch() != voice_[active_voice_].patch()) {
-      voice_[i].mutable_lfo()->Step(float(bus.size()));
-      voice_[i].set_modulations(voice_[i].lfo());
-    } else {
-      voice_[i].set_modulations(voice_[active_voice_].lfo());
+void SixOpEngine::set_patch_library(fm::PatchLibrary *library) {
+  for (int i = 0; i < kMaxSixOpVoices; ++i) {
+    if (library_patch_[i] != -1) {
+      patch_library_->Release(library_patch_[i]);
+      library_patch_[i] = -1;
+      voices_.SetPatch(i, &bank[0][0], &setups[0][0]);
     }
   }
+  patch_library_ = library;
+}
 
-  std::copy(acc_buffer_.data(),
-            &acc_buffer_[(kNumSixOpVoices - 1) * bus.size()],
-            temp_buffer_.data());
-
-  std::fill(&temp_buffer_[(kNumSixOpVoices - 1) * bus.size()],
-            &temp_buffer_[kNumSixOpVoices * bus.size()], 0.0f);
+bool SixOpEngine::PreparePatch(float harmonics) {
+  if (!patch_library_ || !patch_library_->size()) {
+    return false;
+  }
+  return patch_library_->Prepare(
+      static_cast<unsigned>(harmonics) % patch_library_->size());
+}
 
-  rendered_voice_ = (rendered_voice_ + 1) % kNumSixOpVoices;
+void SixOpEngine::LoadPatch(int voice, unsigned index) {
+  if (library_patch_[voice] != -1) {
+    patch_library_->Release(library_patch_[voice]);
+    library_patch_[voice] = -1;
+  }
+  if (patch_library_ && patch_library_->size()) {
+    index %= patch_library_->size();
+    const fm::PatchLibrary::CachedPatch *p = patch_library_->Acquire(index);
+    if (p) {
+      library_patch_[voice] = int32_t(index);
+      voices_.SetPatch(voice, &p->patch, &p->setup);
+      return;
+    }
+  }
+  const auto patch_bank = (index / kNumPatchesPerBank) % bank.size();
+  const auto patch_index = index % kNumPatchesPerBank;
+  voices_.SetPatch(voice, &bank[patch_bank][patch_index],
+                   &setups[patch_bank][patch_index]);
+}
 
-  voice_[rendered_voice_].Render(temp_buffer_.data(),
-                                 bus.size() * kNumSixOpVoices);
+void SixOpEngine::Render(const EngineParameters &parameters, float *out,
+                         float *aux, size_t size, bool *already_enveloped) {
+  if (parameters.trigger & TRIGGER_RISING_EDGE) {
+    active_voice_ = voices_.Allocate(polyphony_);
+    LoadPatch(active_voice_, static_cast<unsigned>(parameters.harmonics));
+    voices_.Trigger(active_voice_);
+  }
+  voices_.Render(parameters, active_voice_, out, size);
 
-  for (size_t i = 0; i < bus.size(); ++i) {
-    bus[i].left =
-        ToySynth::Fixed::from_float(SoftClip(temp_buffer_[i] * 0.25f));
+  for (size_t i = 0; i < size; ++i) {
+    out[i] = SoftClip(out[i] * 0.25f);
   }
-  copy(&temp_buffer_[bus.size()], &temp_buffer_[kNumSixOpVoices * bus.size()],
-       &acc_buffer_[0]);
+  copy(&out[0], &out[size], &aux[0]);
 }
 
 } // namespace plaits
@@ -32,59 +32,86 @@
 #include "plaits/dsp/dsp.h"
 
 #include "plaits/dsp/engine/engine.h"
-#include "plaits/dsp/fm/algorithms.h"
-#include "plaits/dsp/fm/lfo.h"
+#include "plaits/dsp/engine2/fm_voice_pool.h"
 #include "plaits/dsp/fm/patch.h"
+#include "plaits/dsp/fm/patch_library.h"
 #include "plaits/dsp/fm/voice.h"
-#include "synth/block.hh"
+#include <algorithm>
 #include <array>
 
 namespace plaits {
 
-const int kNumSixOpVoices = 2;
+// The engine plays up to kMaxSixOpVoices notes at once, with a polyphony that
+// can be lowered at run time to fit a CPU budget (see SixOpCostModel).
+const int kMaxSixOpVoices = 8;
+const int kDefaultSixOpPolyphony = 2;
 static constexpr int kNumPatchesPerBank = 32;
 
-class FMVoice {
-public:
-  void Init(fm::Algorithms<6> *algorithms);
-  void LoadPatch(const fm::Patch *patch);
-  void Render(float *buffer, size_t size);
-
-  inline const fm::Patch *patch() const { return patch_; }
-
-  inline fm::Voice<6>::Parameters *mutable_parameters() { return &parameters_; }
-
-  inline fm::Lfo *mutable_lfo() { return &lfo_; }
-  inline const fm::Lfo &lfo() const { return lfo_; }
-
-  inline void set_modulations(const fm::Lfo &lfo) {
-    parameters_.pitch_mod = lfo.pitch_mod();
-    parameters_.amp_mod = lfo.amp_mod();
+// Worst-case rendering time of the engine, in ns per sample, as a function of
+// its polyphony: all voices sounding, with different algorithms so that none
+// of them share SIMD lanes. The coefficients depend on the machine and the
+// compiler; plaits_bench measures the engine at each polyphony
+// (SixOpEngine/N) to refit them.
+struct SixOpCostModel {
+  float fixed;
+  float per_voice;
+
+  inline float cost(int polyphony) const {
+    return fixed + per_voice * float(polyphony);
   }
 
-private:
-  fm::Voice<6> voice_;
-  fm::Lfo lfo_{};
-  fm::Voice<6>::Parameters parameters_{};
-  const fm::Patch *patch_{};
+  // Largest polyphony whose worst-case cost fits in budget (ns per sample).
+  inline int max_polyphony(float budget) const {
+    int polyphony = int((budget - fixed) / per_voice);
+    return std::clamp(polyphony, 1, kMaxSixOpVoices);
+  }
 };
 
+// Measured on an x86-64 desktop core (-O2 -msse2, 32-sample blocks).
+inline constexpr SixOpCostModel kDefaultSixOpCostModel = {2.0f, 36.0f};
+
 class SixOpEngine {
-public:
-  void Init();
-  void LoadUserData(const uint8_t *user_data);
-  void Render(const EngineParameters &parameters, ToySynth::Synth::Bus &);
+  using VoicePool = FMVoicePool<6, kMaxSixOpVoices>;
 
-  void LoadBank(int bank);
+public:
+  static constexpr size_t kSharedRamSize = VoicePool::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator *allocator);
+  void Reset();
+  // The patch banks are built in, and selected by the HARMONICS parameter.
+  void LoadUserData(const uint8_t *user_data) {}
+
+  // When a non-empty library is set, HARMONICS selects a patch from it
+  // instead of the built-in banks. Its cache must have more slots than
+  // kMaxSixOpVoices, since each voice pins the patch it plays. The library
+  // must not be modified while it is set.
+  void set_patch_library(fm::PatchLibrary *library);
+
+  // Prepares the library patch that HARMONICS selects, so that the next note
+  // finds it in the cache. Call it outside of the audio callback whenever
+  // HARMONICS changes: on a cache miss, the note plays a built-in patch.
+  bool PreparePatch(float harmonics);
+
+  void Render(const EngineParameters &parameters, float *out, float *aux,
+              size_t size, bool *already_enveloped);
+
+  // Voices above the new polyphony are not retriggered, but finish their
+  // release.
+  void set_polyphony(int polyphony) {
+    polyphony_ = std::clamp(polyphony, 1, kMaxSixOpVoices);
+  }
+  inline int polyphony() const { return polyphony_; }
+  inline int num_active_voices() const { return voices_.num_active_voices(); }
 
 private:
-  fm::Algorithms<6> algorithms_;
-  // std::array<fm::Patch, kNumPatchesPerBank> patches_{};
-  std::array<FMVoice, kNumSixOpVoices> voice_{};
-  std::array<float, kMaxBlockSize * 4> temp_buffer_{};
-  std::array<float, kMaxBlockSize * kNumSixOpVoices> acc_buffer_{};
-  int active_voice_{kNumSixOpVoices - 1};
-  int rendered_voice_{};
+  void LoadPatch(int voice, unsigned index);
+
+  VoicePool voices_;
+  fm::PatchLibrary *patch_library_{};
+  // Library patch pinned by each voice, or -1 for a built-in patch.
+  std::array<int32_t, kMaxSixOpVoices> library_patch_{};
+  int polyphony_{kDefaultSixOpPolyphony};
+  int active_voice_{};
 };
 
 } // namespace plaits
@@ -78,7 +78,8 @@ void StringMachineEngine::ComputeRegistration(float registration,
 }
 
 void StringMachineEngine::Render(const EngineParameters &parameters, float *out,
-                                 float *aux, size_t size) {
+                                 float *aux, size_t size,
+                                 bool *already_enveloped) {
   ONE_POLE(morph_lp_, parameters.morph, 0.1f);
   ONE_POLE(timbre_lp_, parameters.timbre, 0.1f);
 
@@ -42,7 +42,7 @@ public:
   void Reset();
   void LoadUserData(const uint8_t *user_data) {}
   void Render(const EngineParameters &parameters, float *out, float *aux,
-              size_t size);
+              size_t size, bool *already_enveloped);
 
 private:
   void ComputeRegistration(float registration, float *amplitudes);
@@ -0,0 +1,97 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Six plucked strings playing the chords of the chord bank, strummed from the
+// lowest to the highest string.
+
+#include "plaits/dsp/engine2/strum_engine.h"
+
+#include <algorithm>
+
+#include "plaits/dsp/dsp.h"
+
+namespace plaits {
+
+using namespace std;
+using namespace stmlib;
+
+// Time between two strings of a strum, in samples.
+static constexpr float kStrumInterval = 0.012f * kSampleRate;
+
+void StrumEngine::Init(BufferAllocator *allocator) {
+  strings_.Init(allocator);
+  Reset();
+}
+
+void StrumEngine::Reset() {
+  strings_.Reset();
+  next_string_ = kStrumNumStrings;
+  next_pluck_ = 0.0f;
+  chord_ = -1;
+}
+
+void StrumEngine::PluckNextString(float f0) {
+  // The four notes of the chord, then the two lowest an octave up.
+  const int note = next_string_ % kChordNumNotes;
+  const float octave = next_string_ >= kChordNumNotes ? 2.0f : 1.0f;
+  strings_.set_f0(next_string_, f0 * chords_.ratio(note) * octave);
+  strings_.Pluck(next_string_, pluck_amplitude_);
+  ++next_string_;
+  next_pluck_ += kStrumInterval;
+}
+
+void StrumEngine::Render(const EngineParameters &parameters, float *out,
+                         float *aux, size_t size, bool *already_enveloped) {
+  const int chord =
+      static_cast<unsigned>(parameters.harmonics) % kChordNumChords;
+  const bool strum = parameters.trigger & TRIGGER_UNPATCHED
+                         ? chord != chord_
+                         : parameters.trigger & TRIGGER_RISING_EDGE;
+  chord_ = chord;
+  if (strum) {
+    chords_.set_chord(chord);
+    next_string_ = 0;
+    next_pluck_ = 0.0f;
+    pluck_amplitude_ = 0.4f + 0.6f * parameters.accent;
+  }
+
+  // The plucks fall on block boundaries, at most one block late.
+  const float f0 = NoteToInc(parameters.note);
+  while (strumming() && next_pluck_ <= 0.0f) {
+    PluckNextString(f0);
+  }
+  if (strumming()) {
+    next_pluck_ -= float(size);
+  }
+
+  fill(&out[0], &out[size], 0.0f);
+  strings_.Process(0.0f, parameters.timbre * parameters.timbre,
+                   parameters.morph, silence_.data(), out, size);
+  for (size_t i = 0; i < size; ++i) {
+    out[i] = SoftClip(out[i]);
+  }
+  copy(&out[0], &out[size], &aux[0]);
+}
+
+} // namespace plaits
@@ -0,0 +1,77 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Six plucked strings playing the chords of the chord bank, strummed from the
+// lowest to the highest string.
+
+#ifndef PLAITS_DSP_ENGINE_STRUM_ENGINE_H_
+#define PLAITS_DSP_ENGINE_STRUM_ENGINE_H_
+
+#include "plaits/dsp/chords/chord_bank.h"
+#include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/physical_modelling/string_bank.h"
+#include <array>
+
+namespace plaits {
+
+const int kStrumNumStrings = 6;
+
+class StrumEngine {
+  using Strings = StringBank<kStrumNumStrings>;
+
+public:
+  static constexpr size_t kSharedRamSize = Strings::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator *allocator);
+  void Reset();
+  void LoadUserData(const uint8_t *user_data) {}
+
+  // HARMONICS selects the chord, TIMBRE the brightness and MORPH the damping.
+  // The strings are strummed on a trigger or, when the trigger is unpatched,
+  // whenever the chord changes. A string is only retuned when it is plucked,
+  // so the previous chord rings on under the strum.
+  void Render(const EngineParameters &parameters, float *out, float *aux,
+              size_t size, bool *already_enveloped);
+
+  inline bool strumming() const { return next_string_ < kStrumNumStrings; }
+
+private:
+  void PluckNextString(float f0);
+
+  Strings strings_;
+  ChordBank chords_{};
+
+  // The strum in progress: the next string to pluck, in how many samples, and
+  // how hard.
+  int next_string_{kStrumNumStrings};
+  float next_pluck_{};
+  float pluck_amplitude_{};
+
+  int chord_{-1};
+  std::array<float, kMaxBlockSize> silence_{};
+};
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_ENGINE_STRUM_ENGINE_H_
@@ -31,6 +31,7 @@
 #include <algorithm>
 
 #include "stmlib/dsp/parameter_interpolator.h"
+#include "stmlib/dsp/units.h"
 
 using namespace std;
 
@@ -40,8 +41,6 @@ using namespace std;
 using namespace stmlib;
 
 void VirtualAnalogVCFEngine::Init(BufferAllocator* allocator) {
-  oscillator_.Init();
-  sub_oscillator_.Init();
   
   svf_[0].Init();
   svf_[1].Init();
@@ -64,7 +63,7 @@ void VirtualAnalogVCFEngine::Render(
     size_t size,
     bool* already_enveloped) {
   // VA Oscillator (saw or PW square) + sub
-  const float f0 = NoteToFrequency(parameters.note);
+  const float f0 = NoteToInc(parameters.note);
 
   float shape = (parameters.morph - 0.25f) * 2.0f + 0.5f;
   CONSTRAIN(shape, 0.5f, 1.0f);
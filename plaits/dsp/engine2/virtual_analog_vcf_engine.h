@@ -37,15 +37,15 @@
 
 namespace plaits {
   
-class VirtualAnalogVCFEngine : public Engine {
+class VirtualAnalogVCFEngine {
  public:
   VirtualAnalogVCFEngine() { }
   ~VirtualAnalogVCFEngine() { }
   
-  virtual void Init(stmlib::BufferAllocator* allocator);
-  virtual void Reset();
-  virtual void LoadUserData(const uint8_t* user_data) { }
-  virtual void Render(const EngineParameters& parameters,
+  void Init(stmlib::BufferAllocator* allocator);
+  void Reset();
+  void LoadUserData(const uint8_t* user_data) { }
+  void Render(const EngineParameters& parameters,
       float* out,
       float* aux,
       size_t size,
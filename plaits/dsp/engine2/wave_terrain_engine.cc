@@ -39,10 +39,9 @@ using namespace std;
 using namespace stmlib;
 
 void WaveTerrainEngine::Init(BufferAllocator* allocator) {
-  path_.Init();
   offset_ = 0.0f;
   terrain_ = 0.0f;
-  temp_buffer_ = allocator->Allocate<float>(kMaxBlockSize * 4);
+  temp_buffer_.Init(allocator);
   user_terrain_ = NULL;
 }
 
@@ -189,7 +188,7 @@ void WaveTerrainEngine::Render(
   float* path_x = &temp_buffer_[0];
   float* path_y = &temp_buffer_[kOversampling * size];
   
-  const float f0 = NoteToFrequency(parameters.note);
+  const float f0 = NoteToInc(parameters.note);
   const float attenuation = max(1.0f - 8.0f * f0, 0.0f);
   const float radius = 0.1f + 0.9f * parameters.timbre * attenuation * \
       (2.0f - attenuation);
@@ -37,21 +37,28 @@
 #define PLAITS_DSP_ENGINE_WAVE_TERRAIN_ENGINE_H_
 
 #include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/engine/engine_buffer.h"
 #include "plaits/dsp/oscillator/sine_oscillator.h"
 
 namespace plaits {
   
-class WaveTerrainEngine : public Engine {
+class WaveTerrainEngine {
  public:
   WaveTerrainEngine() { }
   ~WaveTerrainEngine() { }
   
-  virtual void Init(stmlib::BufferAllocator* allocator);
-  virtual void Reset();
-  virtual void LoadUserData(const uint8_t* user_data) {
+  // Oversampled x and y coordinates of the path.
+  using TempBuffer = EngineBuffer<float, kMaxBlockSize * 4>;
+  
+  // Bytes carved from the shared RAM by Init().
+  static const size_t kSharedRamSize = TempBuffer::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator* allocator);
+  void Reset();
+  void LoadUserData(const uint8_t* user_data) {
     user_terrain_ = (const int8_t*)(user_data);
   }
-  virtual void Render(const EngineParameters& parameters,
+  void Render(const EngineParameters& parameters,
       float* out,
       float* aux,
       size_t size,
@@ -64,7 +71,7 @@ class WaveTerrainEngine : public Engine {
   float offset_;
   float terrain_;
   
-  float* temp_buffer_;
+  TempBuffer temp_buffer_;
   const int8_t* user_terrain_;
   
   DISALLOW_COPY_AND_ASSIGN(WaveTerrainEngine);
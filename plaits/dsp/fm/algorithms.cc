@@ -47,7 +47,7 @@ namespace fm {
   
 /* static */
 template<>
-const uint8_t Algorithms<4>::opcodes_[8][4] = {
+constexpr uint8_t Algorithms<4>::opcodes_[8][4] = {
   {
     // Algorithm 1: 4 -> 3 -> 2 -> 1
     FB | OUT(1),
@@ -108,7 +108,7 @@ const uint8_t Algorithms<4>::opcodes_[8][4] = {
 
 /* static */
 template<>
-const uint8_t Algorithms<6>::opcodes_[32][6] = {
+constexpr uint8_t Algorithms<6>::opcodes_[32][6] = {
   {
      // Algorithm 1
      FB | OUT(1),               // Op 6
@@ -399,58 +399,43 @@ const uint8_t Algorithms<6>::opcodes_[32][6] = {
   }
 };
 
-#define INSTANTIATE_RENDERER(n, m, a) { n, m, a, &RenderOperators<n, m, a> }
+template<int num_operators, size_t... algorithm>
+constexpr std::array<
+    typename Algorithms<num_operators>::RenderFn,
+    sizeof...(algorithm)> MakeRenderers(std::index_sequence<algorithm...>) {
+  typedef Algorithms<num_operators> A;
+  return { &RenderAlgorithm<num_operators, A::Program(algorithm)>... };
+}
+
+template<int num_operators, size_t... algorithm>
+constexpr std::array<
+    typename Algorithms<num_operators>::LanesRenderFn,
+    sizeof...(algorithm)> MakeLanesRenderers(std::index_sequence<algorithm...>) {
+  typedef Algorithms<num_operators> A;
+  return { &RenderAlgorithmLanes<num_operators, A::Program(algorithm)>... };
+}
 
 /* static */
 template<>
-const Algorithms<4>::RendererSpecs Algorithms<4>::renderers_[] = {
-  // Core
-  INSTANTIATE_RENDERER(1, -2, false),
-  INSTANTIATE_RENDERER(1, -2, true),
-  INSTANTIATE_RENDERER(1, -1, false),
-  INSTANTIATE_RENDERER(1, -1, true),
-  INSTANTIATE_RENDERER(1,  0, false),
-  INSTANTIATE_RENDERER(1,  0, true),
-  
-  // Optimized
-  /*INSTANTIATE_RENDERER(4, -1, true),
-  INSTANTIATE_RENDERER(4,  0, true),
-  INSTANTIATE_RENDERER(2, -1, true),
-  INSTANTIATE_RENDERER(2,  0, false),
-  INSTANTIATE_RENDERER(2,  0, true),*/
-
-  { 0, 0, 0, NULL}
-};
+const std::array<Algorithms<4>::RenderFn, 8> Algorithms<4>::render_fn_ =
+    MakeRenderers<4>(std::make_index_sequence<8>());
 
 /* static */
 template<>
-const Algorithms<6>::RendererSpecs Algorithms<6>::renderers_[] = {
-  // Core
-  INSTANTIATE_RENDERER(1, -2, false),
-  INSTANTIATE_RENDERER(1, -2, true),
-  INSTANTIATE_RENDERER(1, -1, false),
-  INSTANTIATE_RENDERER(1, -1, true),
-  INSTANTIATE_RENDERER(1,  0, false),
-  INSTANTIATE_RENDERER(1,  0, true),
-  
-  // Pesky feedback loops spanning several operators
-  INSTANTIATE_RENDERER(3,  2, true),
-  INSTANTIATE_RENDERER(2,  1, true),
+const std::array<Algorithms<4>::LanesRenderFn, 8>
+Algorithms<4>::render_lanes_fn_ =
+    MakeLanesRenderers<4>(std::make_index_sequence<8>());
 
-  // Optimized
-  /*INSTANTIATE_RENDERER(4, -1, true),
-  INSTANTIATE_RENDERER(4,  0, true),
-  INSTANTIATE_RENDERER(3, -1, false),
-  INSTANTIATE_RENDERER(3, -1, true),
-  INSTANTIATE_RENDERER(3,  0, true),
-  INSTANTIATE_RENDERER(2, -2, true),
-  INSTANTIATE_RENDERER(2, -1, false),
-  INSTANTIATE_RENDERER(2, -1, true),
-  INSTANTIATE_RENDERER(2,  0, false),
-  INSTANTIATE_RENDERER(2,  0, true),*/
+/* static */
+template<>
+const std::array<Algorithms<6>::RenderFn, 32> Algorithms<6>::render_fn_ =
+    MakeRenderers<6>(std::make_index_sequence<32>());
 
-  { 0, 0, 0, NULL}
-};
+/* static */
+template<>
+const std::array<Algorithms<6>::LanesRenderFn, 32>
+Algorithms<6>::render_lanes_fn_ =
+    MakeLanesRenderers<6>(std::make_index_sequence<32>());
 
 }  // namespace fm
   
@@ -32,13 +32,31 @@
 #include "stmlib/dsp/dsp.h"
 
 #include "plaits/dsp/fm/operator.h"
+#include "plaits/dsp/simd.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+// When enabled, operators use the polynomial sine (SinePMPoly) rather than the
+// lookup table. It is more accurate and needs no gathers in SIMD lanes, but
+// lengthens the dependency chain from modulator to carrier.
+// #define FM_POLYNOMIAL_SINE
 
 namespace plaits {
 
 namespace fm {
 
+template <typename Phase, typename PM>
+inline auto OperatorSine(Phase phase, PM pm) {
+#ifdef FM_POLYNOMIAL_SINE
+  return SinePMPoly(phase, pm);
+#else
+  return SinePM(phase, pm);
+#endif // FM_POLYNOMIAL_SINE
+}
+
 // Number of algorithms as a function of the number of operators.
 template<int num_operators> struct NumAlgorithms { enum { N = 1 }; };
 template<> struct NumAlgorithms<4> { enum { N = 8 }; };
@@ -52,14 +70,10 @@ template<> struct NumAlgorithms<6> { enum { N = 32 }; };
 // its phase modulation signal and to which buffer it writes the result.
 // This data is compact - 1 byte / algorithm / operator.
 //
-// At run time, this data is "compiled" into a sequence of function calls
-// to pre-compiled renderers. A renderer is specialized to efficiently render
-// (without any branching, and as much loop unrolling as possible) one
-// operator or a group of operators.
-//
-// Different code space and speed trade-off can be obtained by increasing the
-// palette of available renderers (for example by specializing the code for
-// a renderer rendering in a single pass a "tower" of 4 operators).
+// Each algorithm is compiled ahead of time into a single renderer processing
+// all its operators in one pass (see RenderAlgorithm below), so selecting an
+// algorithm is a table lookup. This trades code space (one renderer per
+// algorithm) for speed.
 template<int num_operators>
 class Algorithms {
  public:
@@ -78,134 +92,258 @@ class Algorithms {
     FEEDBACK_SOURCE_FLAG = 0x40,
   };
   
-  struct RenderCall {
-    RenderFn render_fn;
-    int n;
-    int input_index;
-    int output_index;
-  };
+  // Renders all the operators of a voice, adding the carriers to out.
+  typedef void (*RenderFn)(
+      Operator* ops,
+      const float* f,
+      const float* a,
+      float* fb_state,
+      int fb_amount,
+      float* out,
+      size_t size);
   
-  inline void Init() {
-    for (int i = 0; i < NUM_ALGORITHMS; ++i) {
-      Compile(i);
-    }
+  // Same for simd::kNumLanes voices, with the operators' parameters and the
+  // output stored lane by lane (see RenderAlgorithmLanes below).
+  typedef void (*LanesRenderFn)(
+      Operator* const* ops,
+      const float* f,
+      const float* a,
+      float* fb_state,
+      const int* fb_amount,
+      float* out,
+      size_t size);
+  
+  inline RenderFn render_fn(int algorithm) const {
+    return render_fn_[algorithm];
   }
   
-  inline const RenderCall& render_call(int algorithm, int op) const {
-    return render_call_[algorithm][op];
+  inline LanesRenderFn render_lanes_fn(int algorithm) const {
+    return render_lanes_fn_[algorithm];
   }
   
   inline bool is_modulator(int algorithm, int op) const {
     return opcodes_[algorithm][op] & DESTINATION_MASK;
   }
   
- private:
-  struct RendererSpecs {
-    int n;
-    int modulation_source;
-    bool additive;
-    RenderFn render_fn;
-  };
-     
-  inline RenderFn GetRenderer(int n, int modulation_source, bool additive) {
-    for (const RendererSpecs* r = renderers_; r->n; ++r) {
-      if (r->n == n && \
-          r->modulation_source == modulation_source && \
-          r->additive == additive) {
-        return r->render_fn;
-      }
+  // Packs the opcodes of an algorithm into a template argument for the
+  // renderers, one byte per operator.
+  static constexpr uint64_t Program(int algorithm) {
+    uint64_t program = 0;
+    for (int i = 0; i < num_operators; ++i) {
+      program |= uint64_t(opcodes_[algorithm][i]) << (8 * i);
     }
-    return NULL;
+    return program;
   }
   
-  inline void Compile(int algorithm) {
-    const uint8_t* opcodes = opcodes_[algorithm];
-    for (int i = 0; i < num_operators; ) {
-      uint8_t opcode = opcodes[i];
-
-      int n = 1;
-    
-      while (i + n < num_operators) {
-        uint8_t from = opcodes[i + n - 1];
-        uint8_t to = (opcodes[i + n] & SOURCE_MASK) >> 4;
-
-        bool has_additive = from & ADDITIVE_FLAG;
-        bool broken = (from & DESTINATION_MASK) != to;
-
-        if (has_additive || broken) {
-          if (to == (opcode & DESTINATION_MASK)) {
-            // If the same modulation happens to be reused by subsequent
-            // operators (algorithms 19 to 25), discard the chain.
-            n = 1;
-          }
-          break;
-        }
-        ++n;
-      }
-    
-      // Try to find if a pre-compiled renderer is available for this chain.
-      for (int attempt = 0; attempt < 2; ++attempt) {
-        uint8_t out_opcode = opcodes[i + n - 1];
-        bool additive = out_opcode & ADDITIVE_FLAG;
+ private:
+  static const uint8_t opcodes_[NUM_ALGORITHMS][num_operators];
+  static const std::array<RenderFn, NUM_ALGORITHMS> render_fn_;
+  static const std::array<LanesRenderFn, NUM_ALGORITHMS> render_lanes_fn_;
+  
+  DISALLOW_COPY_AND_ASSIGN(Algorithms);
+};
+
+// Calls fn(std::integral_constant<int, i>) for i = 0 .. n - 1.
+template<int n, typename F>
+inline void ForEachOperator(F&& fn) {
+  [&]<int... i>(std::integer_sequence<int, i...>) {
+    (fn(std::integral_constant<int, i>{}), ...);
+  }(std::make_integer_sequence<int, n>{});
+}
+
+// Renders one algorithm, given as a packed program. The routing is resolved
+// at compile time: the operators' state and the modulation signals stay in
+// registers, and the carriers are summed into out once per sample.
+template<int num_operators, uint64_t program>
+void RenderAlgorithm(
+    Operator* ops,
+    const float* f,
+    const float* a,
+    float* fb_state,
+    int fb_amount,
+    float* out,
+    size_t size) {
+  typedef Algorithms<num_operators> A;
+  
+  uint32_t frequency[num_operators];
+  uint32_t phase[num_operators];
+  float amplitude[num_operators];
+  float amplitude_increment[num_operators];
+
+  const float scale = 1.0f / float(size);
+  for (int i = 0; i < num_operators; ++i) {
+    frequency[i] = static_cast<uint32_t>(std::min(f[i], 0.5f) * 4294967296.0f);
+    phase[i] = ops[i].phase;
+    amplitude[i] = ops[i].amplitude;
+    amplitude_increment[i] = (std::min(a[i], 4.0f) - amplitude[i]) * scale;
+  }
+  
+  float previous_0 = fb_state[0];
+  float previous_1 = fb_state[1];
+  const float fb_scale = fb_amount ? float(1 << fb_amount) / 512.0f : 0.0f;
+
+  while (size--) {
+    // Buffer 0 accumulates the carriers, buffers 1 and 2 hold the modulation
+    // signals.
+    float buffer[3] = { *out, 0.0f, 0.0f };
+    ForEachOperator<num_operators>([&](auto op) {
+      constexpr int i = op;
+      constexpr uint8_t opcode = uint8_t(program >> (8 * i));
+      constexpr int source = (opcode & A::SOURCE_MASK) >> 4;
+      constexpr int destination = opcode & A::DESTINATION_MASK;
       
-        int modulation_source = -3;
-        if (!(opcode & SOURCE_MASK)) {
-          modulation_source = -1;
-        } else if ((opcode & SOURCE_MASK) != SOURCE_FEEDBACK) {
-          modulation_source = -2;
-        } else {
-          for (int j = 0; j < n; ++j) {
-            if (opcodes[i + j] & FEEDBACK_SOURCE_FLAG) {
-              modulation_source = j;
-            }
-          }
-        }
-        RenderFn fn = GetRenderer(n, modulation_source, additive);
-        if (fn) {
-          RenderCall* call = &render_call_[algorithm][i];
-          call->render_fn = fn;
-          call->n = n;
-          call->input_index = (opcode & SOURCE_MASK) >> 4;
-          call->output_index = out_opcode & DESTINATION_MASK;
-          // printf("  Algo %02d. Op %d uses renderer (%d, %d, %d)\n",
-          //        algorithm + 1,
-          //        num_operators - i,
-          //        n, modulation_source, additive);
-          break;
-        } else {
-          // printf("! Algo %02d. Op %d: no renderer for (%d, %d, %d)\n",
-          //        algorithm + 1,
-          //        num_operators - i,
-          //        n, modulation_source, additive);
-          if (n == 1) {
-            // assert(false);
-          } else {
-            n = 1;
-          }
-        }
+      float pm = 0.0f;
+      if constexpr ((opcode & A::SOURCE_MASK) == A::SOURCE_FEEDBACK) {
+        pm = (previous_0 + previous_1) * fb_scale;
+      } else if constexpr (source) {
+        pm = buffer[source];
       }
-      i += n;
+      phase[i] += frequency[i];
+      const float y = OperatorSine(phase[i], pm) * amplitude[i];
+      amplitude[i] += amplitude_increment[i];
+      if constexpr (opcode & A::FEEDBACK_SOURCE_FLAG) {
+        previous_1 = previous_0;
+        previous_0 = y;
+      }
+      if constexpr (opcode & A::ADDITIVE_FLAG) {
+        buffer[destination] += y;
+      } else {
+        buffer[destination] = y;
+      }
+    });
+    *out++ = buffer[0];
+  }
+  
+  for (int i = 0; i < num_operators; ++i) {
+    ops[i].phase = phase[i];
+    ops[i].amplitude = amplitude[i];
+  }
+  fb_state[0] = previous_0;
+  fb_state[1] = previous_1;
+}
+
+// RenderAlgorithm for simd::kNumLanes voices at once.
+//
+// ops[l] points to the operators of the voice of lane l. The frequencies,
+// amplitudes and feedback state are stored lane by lane (f[i * kNumLanes + l]
+// is for operator i of lane l), and so is the output (sample t of lane l is
+// at index t * kNumLanes + l). The feedback amount can differ between lanes,
+// but the algorithm cannot.
+template<int num_operators, uint64_t program>
+void RenderAlgorithmLanes(
+    Operator* const* ops,
+    const float* f,
+    const float* a,
+    float* fb_state,
+    const int* fb_amount,
+    float* out,
+    size_t size) {
+  using namespace simd;
+  typedef Algorithms<num_operators> A;
+  const size_t lanes = kNumLanes;
+  
+  Int frequency[num_operators];
+  Int phase[num_operators];
+  Float amplitude[num_operators];
+  Float amplitude_increment[num_operators];
+
+  const float scale = 1.0f / float(size);
+  for (int i = 0; i < num_operators; ++i) {
+    uint32_t lane_frequency[lanes];
+    uint32_t lane_phase[lanes];
+    float lane_amplitude[lanes];
+    float lane_increment[lanes];
+    for (size_t l = 0; l < lanes; ++l) {
+      const float f_l = f[i * lanes + l];
+      const float a_l = a[i * lanes + l];
+      lane_frequency[l] = static_cast<uint32_t>(
+          std::min(f_l, 0.5f) * 4294967296.0f);
+      lane_phase[l] = ops[l][i].phase;
+      lane_amplitude[l] = ops[l][i].amplitude;
+      lane_increment[l] = (std::min(a_l, 4.0f) - lane_amplitude[l]) * scale;
     }
+    frequency[i] = Load(lane_frequency);
+    phase[i] = Load(lane_phase);
+    amplitude[i] = Load(lane_amplitude);
+    amplitude_increment[i] = Load(lane_increment);
   }
   
-  RenderCall render_call_[NUM_ALGORITHMS][num_operators];
-  static const uint8_t opcodes_[NUM_ALGORITHMS][num_operators];
-  static const RendererSpecs renderers_[];
+  float lane_fb_scale[lanes];
+  for (size_t l = 0; l < lanes; ++l) {
+    lane_fb_scale[l] = fb_amount[l] ? float(1 << fb_amount[l]) / 512.0f : 0.0f;
+  }
+  const Float fb_scale = Load(lane_fb_scale);
+  Float previous_0 = Load(fb_state);
+  Float previous_1 = Load(fb_state + lanes);
   
-  DISALLOW_COPY_AND_ASSIGN(Algorithms);
-};
+  while (size--) {
+    Float buffer[3] = { Load(out), Set(0.0f), Set(0.0f) };
+    ForEachOperator<num_operators>([&](auto op) {
+      constexpr int i = op;
+      constexpr uint8_t opcode = uint8_t(program >> (8 * i));
+      constexpr int source = (opcode & A::SOURCE_MASK) >> 4;
+      constexpr int destination = opcode & A::DESTINATION_MASK;
+      
+      Float pm = Set(0.0f);
+      if constexpr ((opcode & A::SOURCE_MASK) == A::SOURCE_FEEDBACK) {
+        pm = Mul(Add(previous_0, previous_1), fb_scale);
+      } else if constexpr (source) {
+        pm = buffer[source];
+      }
+      phase[i] = Add(phase[i], frequency[i]);
+      const Float y = Mul(OperatorSine(phase[i], pm), amplitude[i]);
+      amplitude[i] = Add(amplitude[i], amplitude_increment[i]);
+      if constexpr (opcode & A::FEEDBACK_SOURCE_FLAG) {
+        previous_1 = previous_0;
+        previous_0 = y;
+      }
+      if constexpr (opcode & A::ADDITIVE_FLAG) {
+        buffer[destination] = Add(buffer[destination], y);
+      } else {
+        buffer[destination] = y;
+      }
+    });
+    Store(out, buffer[0]);
+    out += lanes;
+  }
+  
+  for (int i = 0; i < num_operators; ++i) {
+    uint32_t lane_phase[lanes];
+    float lane_amplitude[lanes];
+    Store(lane_phase, phase[i]);
+    Store(lane_amplitude, amplitude[i]);
+    for (size_t l = 0; l < lanes; ++l) {
+      ops[l][i].phase = lane_phase[l];
+      ops[l][i].amplitude = lane_amplitude[l];
+    }
+  }
+  Store(fb_state, previous_0);
+  Store(fb_state + lanes, previous_1);
+}
 
 /* static */
 template<> const uint8_t Algorithms<4>::opcodes_[][4];  // From DX100
 
 /* static */
-template<> const Algorithms<4>::RendererSpecs Algorithms<4>::renderers_[];
+template<> const uint8_t Algorithms<6>::opcodes_[][6];  // From DX7
 
 /* static */
-template<> const uint8_t Algorithms<6>::opcodes_[][6];  // From DX7
+template<>
+const std::array<Algorithms<4>::RenderFn, 8> Algorithms<4>::render_fn_;
+
+/* static */
+template<>
+const std::array<Algorithms<4>::LanesRenderFn, 8>
+Algorithms<4>::render_lanes_fn_;
+
+/* static */
+template<>
+const std::array<Algorithms<6>::RenderFn, 32> Algorithms<6>::render_fn_;
 
 /* static */
-template<> const Algorithms<6>::RendererSpecs Algorithms<6>::renderers_[];
+template<>
+const std::array<Algorithms<6>::LanesRenderFn, 32>
+Algorithms<6>::render_lanes_fn_;
 
 }  // namespace fm
 
@@ -32,18 +32,6 @@ namespace plaits {
 
 namespace fm {
 
-/* extern */
-constexpr float lut_coarse[32] = {
-    -12.000000f, 0.000000f,  12.000000f, 19.019550f, 24.000000f, 27.863137f,
-    31.019550f,  33.688259f, 36.000000f, 38.039100f, 39.863137f, 41.513180f,
-    43.019550f,  44.405276f, 45.688259f, 46.882687f, 48.000000f, 49.049554f,
-    50.039100f,  50.975130f, 51.863137f, 52.707809f, 53.513180f, 54.282743f,
-    55.019550f,  55.726274f, 56.405276f, 57.058650f, 57.688259f, 58.295772f,
-    58.882687f,  59.450356f};
-
-/* extern */
-constexpr float lut_amp_mod_sensitivity[4] = {0.0f, 0.2588f, 0.4274f, 1.0f};
-
 /* extern */
 constexpr float lut_pitch_mod_sensitivity[8] = {
     0.0f,       0.0781250f, 0.1562500f, 0.2578125f,
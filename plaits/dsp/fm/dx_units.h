@@ -36,15 +36,27 @@
 #include <cmath>
 
 #include "plaits/dsp/fm/patch.h"
+#include "plaits/dsp/simd.h"
 
 namespace plaits {
 
 namespace fm {
 
 extern const float lut_cube_root[17];
-extern const float lut_amp_mod_sensitivity[4];
 extern const float lut_pitch_mod_sensitivity[8];
-extern const float lut_coarse[32];
+
+// Defined here rather than in dx_units.cc so that they can be read at compile
+// time, by PatchSetup::Compute().
+inline constexpr float lut_coarse[32] = {
+    -12.000000f, 0.000000f,  12.000000f, 19.019550f, 24.000000f, 27.863137f,
+    31.019550f,  33.688259f, 36.000000f, 38.039100f, 39.863137f, 41.513180f,
+    43.019550f,  44.405276f, 45.688259f, 46.882687f, 48.000000f, 49.049554f,
+    50.039100f,  50.975130f, 51.863137f, 52.707809f, 53.513180f, 54.282743f,
+    55.019550f,  55.726274f, 56.405276f, 57.058650f, 57.688259f, 58.295772f,
+    58.882687f,  59.450356f};
+
+inline constexpr float lut_amp_mod_sensitivity[4] = {
+    0.0f, 0.2588f, 0.4274f, 1.0f};
 
 // Computes 2^x by using a polynomial approximation of 2^frac(x) and directly
 // incrementing the exponent of the IEEE 754 representation of the result
@@ -80,13 +92,35 @@ inline float Pow2Fast(float x) {
   return r.f;
 }
 
+// Same as above, in simd::kNumLanes lanes, with identical results.
+template<int order>
+inline simd::Float Pow2Fast(simd::Float x) {
+  using namespace simd;
+  if constexpr (order == 1) {
+    return AsFloat(Truncate(Mul(Set(float(1 << 23)), Add(Set(127.0f), x))));
+  } else {
+    // Adding the all-ones mask of the negative lanes decrements them.
+    const Int x_integral = Add(Truncate(x), LessThan(x, Set(0.0f)));
+    x = Sub(x, ToFloat(x_integral));
+
+    Float r;
+    if constexpr (order == 2) {
+      r = Add(Set(1.0f), Mul(x, Add(Set(0.6565f), Mul(x, Set(0.3435f)))));
+    } else {
+      r = Add(Set(1.0f), Mul(x, Add(Set(0.6958f),
+          Mul(x, Add(Set(0.2251f), Mul(x, Set(0.0791f)))))));
+    }
+    return AsFloat(Add(AsInt(r), ShiftLeft<23>(x_integral)));
+  }
+}
+
 // Convert an operator (envelope) level from 0-99 to the complement of the
 // "TL" value.
 //   0 =   0  (TL = 127)
 //  20 =  48  (TL =  79)
 //  50 =  78  (TL =  49)
 //  99 = 127  (TL =   0)
-inline int OperatorLevel(int level) {
+constexpr int OperatorLevel(int level) {
   int tlc = int(level);
   if (level < 20) {
     tlc = tlc < 15 ? (tlc * (36 - tlc)) >> 3 : 27 + tlc;
@@ -102,14 +136,15 @@ inline int OperatorLevel(int level) {
 // 50 =  0
 // 82 = +1 octave
 // 99 = +4 octave
-inline float PitchEnvelopeLevel(int level) {
+constexpr float PitchEnvelopeLevel(int level) {
   float l = (float(level) - 50.0f) / 32.0f;
-  float tail = std::max(fabsf(l + 0.02f) - 1.0f, 0.0f);
+  float tail = std::max((l + 0.02f < 0.0f ? -(l + 0.02f) : l + 0.02f) - 1.0f,
+                        0.0f);
   return l * (1.0f + tail * tail * 5.3056f);
 }
 
 // Convert an operator envelope rate from 0-99 to a frequency.
-inline float OperatorEnvelopeIncrement(int rate) {
+constexpr float OperatorEnvelopeIncrement(int rate) {
   int rate_scaled = (rate * 41) >> 6;
   int mantissa = 4 + (rate_scaled & 3);
   int exponent = 2 + (rate_scaled >> 2);
@@ -117,7 +152,7 @@ inline float OperatorEnvelopeIncrement(int rate) {
 }
 
 // Convert a pitch envelope rate from 0-99 to a frequency.
-inline float PitchEnvelopeIncrement(int rate) {
+constexpr float PitchEnvelopeIncrement(int rate) {
   float r = float(rate) * 0.01f;
   return (1.0f + 192.0f * r * (r * r * r * r + 0.3333f)) / (21.3f * 44100.0f);
 }
@@ -158,7 +193,7 @@ inline float RateScaling(float note, int rate_scaling) {
 }
 
 // Operator amplitude modulation sensitivity (0-3).
-inline float AmpModSensitivity(int amp_mod_sensitivity) {
+constexpr float AmpModSensitivity(int amp_mod_sensitivity) {
   return lut_amp_mod_sensitivity[amp_mod_sensitivity];
 }
 
@@ -186,7 +221,31 @@ inline float KeyboardScaling(float note, const Patch::KeyboardScaling& ks) {
   return t * depth * 0.02677f;
 }
 
-inline float FrequencyRatio(const Patch::Operator& op) {
+// 2^(semitones / 12), usable in constant expressions (stmlib's version reads
+// lookup tables). Accurate to the last bit of a float.
+constexpr float SemitonesToRatioExact(float semitones) {
+  const double octaves = double(semitones) / 12.0;
+  int integral = int(octaves);
+  if (octaves < double(integral)) {
+    --integral;
+  }
+  const double x = (octaves - double(integral)) * 0.69314718055994531;
+  double ratio = 1.0;
+  double term = 1.0;
+  for (int i = 1; i < 16; ++i) {
+    term *= x / double(i);
+    ratio += term;
+  }
+  for (; integral > 0; --integral) {
+    ratio *= 2.0;
+  }
+  for (; integral < 0; ++integral) {
+    ratio *= 0.5;
+  }
+  return float(ratio);
+}
+
+constexpr float FrequencyRatio(const Patch::Operator& op) {
   const float detune = op.mode == 0 && op.fine
       ? 1.0f + 0.01f * float(op.fine)
       : 1.0f;
@@ -196,7 +255,7 @@ inline float FrequencyRatio(const Patch::Operator& op) {
       : float(int(op.coarse & 3) * 100 + op.fine) * 0.39864f;
   base += (float(op.detune) - 7.0f) * 0.015f;
 
-  return stmlib::SemitonesToRatioSafe(base) * detune;
+  return SemitonesToRatioExact(base) * detune;
 }
 
 }  // namespace fm
@@ -33,6 +33,9 @@
 //
 // The unusual RenderAtSample() method allows the evaluation of the envelope at
 // an arbitrary point in time, used in Plaits' "envelope scrubbing" feature.
+// The start time of each stage is precomputed with the shape, and the search
+// for the stage containing t resumes from the previous call's, so scrubbing at
+// a constant or slowly moving position costs a couple of comparisons.
 //
 // A couple of quirks from the DX-series' operator envelopes are implemented,
 // namely:
@@ -54,47 +57,54 @@ namespace plaits {
 
 namespace fm {
 
+// Rates and levels of an envelope's segments. Shapes are computed once per
+// patch (possibly at compile time), and envelopes only keep a pointer to them.
+template <int num_stages> struct EnvelopeShape {
+  std::array<float, num_stages> increment;
+  std::array<float, num_stages> level;
+  // Time at which each stage starts when the envelope is scrubbed. The last
+  // entry is the end of the decay, after which the sustain level is held.
+  std::array<float, num_stages> start;
+
+  constexpr void ComputeStageStarts() {
+    start[0] = 0.0f;
+    for (int i = 1; i < num_stages; ++i) {
+      start[i] = start[i - 1] + 1.0f / increment[i - 1];
+    }
+  }
+};
+
 template <float scale_ = 1, int num_stages = 4,
           bool reshape_ascending_segments = false>
 class Envelope {
 public:
   enum { NUM_STAGES = num_stages, PREVIOUS_LEVEL = -100 };
 
-  // Directly copy the variables.
-  void Set(const float increment[num_stages], const float level[num_stages]) {
-    std::copy(&increment[0], &increment[num_stages], &increment_[0]);
-    std::copy(&level[0], &level[num_stages], &level_[0]);
+  using Shape = EnvelopeShape<num_stages>;
+
+  inline void Set(const Shape *shape) {
+    shape_ = shape;
+    scrub_time_ = -1.0f;
   }
 
   inline float RenderAtSample(float t, const float gate_duration) {
+    // In sustain mode, t only moves with the envelope control.
+    if (t == scrub_time_) {
+      return scrub_value_;
+    }
+    scrub_time_ = t;
     if (t > gate_duration) {
       // Check how far we are into the release phase.
-      const float phase = (t - gate_duration) * increment_[num_stages - 1];
-      return phase >= 1.0f
-                 ? level_[num_stages - 1]
-                 : value(num_stages - 1, phase,
-                         RenderAtSample(gate_duration, gate_duration));
-    }
-
-    int stage = 0;
-    for (; stage < num_stages - 1; ++stage) {
-      const float stage_duration = 1.0f / increment_[stage];
-      if (t < stage_duration) {
-        break;
-      }
-      t -= stage_duration;
-    }
-
-    if (stage == num_stages - 1) {
-      t -= gate_duration;
-      if (t <= 0.0f) {
-        // TODO(pichenettes): this should always be true.
-        return level_[num_stages - 2];
-      } else if (t * increment_[num_stages - 1] > 1.0f) {
-        return level_[num_stages - 1];
-      }
+      const float phase =
+          (t - gate_duration) * shape_->increment[num_stages - 1];
+      scrub_value_ = phase >= 1.0f
+                         ? shape_->level[num_stages - 1]
+                         : value(num_stages - 1, phase,
+                                 Scrub(gate_duration, &release_stage_));
+    } else {
+      scrub_value_ = Scrub(t, &scrub_stage_);
     }
-    return value(stage, t * increment_[stage], PREVIOUS_LEVEL);
+    return scrub_value_;
   }
 
   inline float Render(bool gate) { return Render(gate, 1.0f, 1.0f, 1.0f); }
@@ -114,7 +124,7 @@ public:
         phase_ = 0.0f;
       }
     }
-    phase_ += increment_[stage_] * rate *
+    phase_ += shape_->increment[stage_] * rate *
               (stage_ == num_stages - 1 ? release_scale : ad_scale);
     if (phase_ >= 1.0f) {
       if (stage_ >= num_stages - 2) {
@@ -132,11 +142,30 @@ public:
 private:
   inline float value() { return value(stage_, phase_, start_); }
 
+  // Value at a time t before the gate ends. *stage is the stage found by the
+  // previous call, from which the search starts; a jump of t across several
+  // stages walks through them.
+  inline float Scrub(float t, int *stage) {
+    const auto &start = shape_->start;
+    int s = *stage;
+    while (s > 0 && t < start[s]) {
+      --s;
+    }
+    while (s < num_stages - 1 && t >= start[s + 1]) {
+      ++s;
+    }
+    *stage = s;
+    if (s == num_stages - 1) {
+      return shape_->level[num_stages - 2];
+    }
+    return value(s, (t - start[s]) * shape_->increment[s], PREVIOUS_LEVEL);
+  }
+
   inline float value(int stage, float phase, float start_level) {
     float from = start_level == static_cast<float>(PREVIOUS_LEVEL)
-                     ? level_[(stage - 1 + num_stages) % num_stages]
+                     ? shape_->level[(stage - 1 + num_stages) % num_stages]
                      : start_level;
-    float to = level_[stage];
+    float to = shape_->level[stage];
 
     if constexpr (reshape_ascending_segments) {
       if (from < to) {
@@ -149,28 +178,28 @@ private:
     return phase * (to - from) + from;
   }
 
+  static constexpr Shape default_shape_ = []() {
+    Shape out{};
+    for (int i = 0; i < num_stages; ++i) {
+      out.increment[i] = 0.001f;
+      out.level[i] = i == num_stages - 1 ? 0.0f : 1.0f / float(1 << i);
+    }
+    out.ComputeStageStarts();
+    return out;
+  }();
+
   int stage_{num_stages - 1};
   float phase_{1.f};
   float start_{0.f};
 
-protected:
-  using Inc = std::array<float, num_stages>;
-  using Lev = Inc;
-  Inc increment_ = []() {
-    Inc out{};
-    for (auto &o : out) {
-      o = .001f;
-    }
-    return out;
-  }();
+  // Last RenderAtSample() call, and the stages it found before and after the
+  // end of the gate.
+  float scrub_time_{-1.0f};
+  float scrub_value_{};
+  int scrub_stage_{};
+  int release_stage_{};
 
-  Lev level_ = []() {
-    Lev out{};
-    for (auto i = 0u; i < out.size() - 1; ++i) {
-      out[i] = 1.f / (1 << i);
-    }
-    return out;
-  }();
+  const Shape *shape_{&default_shape_};
 };
 
 template <float scale>
@@ -178,21 +207,26 @@ class OperatorEnvelope : public Envelope<scale, 4, true> {
   static constexpr auto NUM_STAGES = 4;
 
 public:
-  void Set(const uint8_t rate[NUM_STAGES], const uint8_t level[NUM_STAGES],
-           uint8_t global_level) {
+  using Shape = EnvelopeShape<NUM_STAGES>;
+
+  static constexpr Shape ComputeShape(const uint8_t rate[NUM_STAGES],
+                                      const uint8_t level[NUM_STAGES],
+                                      uint8_t global_level) {
+    Shape shape{};
+
     // Configure levels.
     for (int i = 0; i < NUM_STAGES; ++i) {
       int level_scaled = OperatorLevel(level[i]);
       level_scaled = (level_scaled & ~1) + global_level - 133; // 125 ?
-      this->level_[i] =
+      shape.level[i] =
           0.125f * (level_scaled < 1 ? 0.5f : static_cast<float>(level_scaled));
     }
 
     // Configure increments.
     for (int i = 0; i < NUM_STAGES; ++i) {
       float increment = OperatorEnvelopeIncrement(rate[i]);
-      float from = this->level_[(i - 1 + NUM_STAGES) % NUM_STAGES];
-      float to = this->level_[i];
+      float from = shape.level[(i - 1 + NUM_STAGES) % NUM_STAGES];
+      float to = shape.level[i];
 
       if (from == to) {
         // Quirk: for plateaux, the increment is scaled.
@@ -214,8 +248,10 @@ public:
       } else {
         increment *= 1.0f / (from - to);
       }
-      this->increment_[i] = increment * scale;
+      shape.increment[i] = increment * scale;
     }
+    shape.ComputeStageStarts();
+    return shape;
   }
 };
 
@@ -223,24 +259,31 @@ template <float scale> class PitchEnvelope : public Envelope<scale, 4, false> {
   static constexpr auto NUM_STAGES = 4;
 
 public:
-  void Set(const uint8_t rate[NUM_STAGES], const uint8_t level[NUM_STAGES]) {
+  using Shape = EnvelopeShape<NUM_STAGES>;
+
+  static constexpr Shape ComputeShape(const uint8_t rate[NUM_STAGES],
+                                      const uint8_t level[NUM_STAGES]) {
+    Shape shape{};
+
     // Configure levels.
     for (int i = 0; i < NUM_STAGES; ++i) {
-      this->level_[i] = PitchEnvelopeLevel(level[i]);
+      shape.level[i] = PitchEnvelopeLevel(level[i]);
     }
 
     // Configure increments.
     for (int i = 0; i < NUM_STAGES; ++i) {
-      float from = this->level_[(i - 1 + NUM_STAGES) % NUM_STAGES];
-      float to = this->level_[i];
+      float from = shape.level[(i - 1 + NUM_STAGES) % NUM_STAGES];
+      float to = shape.level[i];
       float increment = PitchEnvelopeIncrement(rate[i]);
       if (from != to) {
-        increment *= 1.0f / fabsf(from - to);
+        increment *= 1.0f / (from < to ? to - from : from - to);
       } else if (i != NUM_STAGES - 1) {
         increment = 0.2f;
       }
-      this->increment_[i] = increment * scale;
+      shape.increment[i] = increment * scale;
     }
+    shape.ComputeStageStarts();
+    return shape;
   }
 };
 
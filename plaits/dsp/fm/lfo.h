@@ -29,6 +29,7 @@
 #ifndef PLAITS_DSP_FM_LFO_H_
 #define PLAITS_DSP_FM_LFO_H_
 
+#include "conf/toy_synth.hh"
 #include "core/random.hh"
 
 #include "plaits/dsp/fm/dx_units.h"
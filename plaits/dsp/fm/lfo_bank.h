@@ -0,0 +1,232 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// A bank of DX7-compatible LFOs, stepped together in SIMD lanes.
+//
+// Voices playing the same patch share an LFO, as on the DX7 where all voices
+// follow a single LFO. The sample & hold waveform draws from a random stream
+// owned by each LFO, so that rendering is reproducible from the seed.
+
+#ifndef PLAITS_DSP_FM_LFO_BANK_H_
+#define PLAITS_DSP_FM_LFO_BANK_H_
+
+#include "conf/toy_synth.hh"
+
+#include "plaits/dsp/fm/dx_units.h"
+#include "plaits/dsp/fm/lfo.h"
+#include "plaits/dsp/fm/patch.h"
+#include "plaits/dsp/oscillator/sine_oscillator.h"
+#include "plaits/dsp/simd.h"
+#include <array>
+
+namespace plaits {
+
+namespace fm {
+
+template <size_t num_lfos> class LfoBank {
+public:
+  // Padded to whole SIMD vectors; the extra LFOs are stepped but never used.
+  static constexpr size_t kSize =
+      (num_lfos + simd::kNumLanes - 1) / simd::kNumLanes * simd::kNumLanes;
+
+  void Init(uint32_t seed) {
+    patch_.fill(nullptr);
+    num_users_.fill(0);
+    for (size_t i = 0; i < kSize; ++i) {
+      SetModulations(i, Patch::ModulationParameters{});
+      phase_[i] = delay_phase_[i] = 0.0f;
+      value_[i] = random_value_[i] = 0.0f;
+      pitch_mod_[i] = amp_mod_[i] = 0.0f;
+    }
+    Seed(seed);
+  }
+
+  // Restarts the random streams. LFO i draws from the xorshift32 sequence
+  // started at a hash of (seed, i).
+  void Seed(uint32_t seed) {
+    for (size_t i = 0; i < kSize; ++i) {
+      uint32_t x = (seed + uint32_t(i)) * 0x9e3779b9u;
+      x = (x ^ (x >> 16)) * 0x85ebca6bu;
+      x ^= x >> 13;
+      random_state_[i] = x ? x : 1;
+    }
+  }
+
+  // Returns the LFO of the voices playing patch, or assigns a free one to it.
+  // An LFO released by the last voice on a patch is picked up again, with its
+  // phase, by the next voice on that patch. Its settings are read again, since
+  // the patch may have been reloaded at the same address in the meantime. Each
+  // voice holds at most one LFO, so with one voice per LFO there is always one
+  // free.
+  int Acquire(const Patch *patch) {
+    int free = -1;
+    for (size_t i = 0; i < num_lfos; ++i) {
+      if (patch_[i] == patch) {
+        if (!num_users_[i]) {
+          SetModulations(i, patch->modulations);
+        }
+        ++num_users_[i];
+        return int(i);
+      }
+      if (!num_users_[i] && (free == -1 || (patch_[free] && !patch_[i]))) {
+        free = int(i);
+      }
+    }
+    if (free != -1) {
+      patch_[free] = patch;
+      num_users_[free] = 1;
+      SetModulations(size_t(free), patch->modulations);
+    }
+    return free;
+  }
+
+  void Release(int lfo) {
+    --num_users_[lfo];
+  }
+
+  // On note on.
+  void Reset(int lfo) {
+    if (reset_phase_[lfo]) {
+      phase_[lfo] = 0.0f;
+    }
+    delay_phase_[lfo] = 0.0f;
+  }
+
+  // Advances all the LFOs by scale samples, as Lfo::Step() does (the sine
+  // waveform is approximated by SinePMPoly() instead of the lookup table).
+  void Step(float scale) {
+    using namespace simd;
+    const Float s = Set(scale);
+    const Float zero = Set(0.0f);
+    const Float half = Set(0.5f);
+    const Float one = Set(1.0f);
+    for (size_t i = 0; i < kSize; i += kNumLanes) {
+      Float phase = Add(Load(&phase_[i]), Mul(s, Load(&frequency_[i])));
+      const Int running = LessThan(phase, one);
+      phase = Select(running, phase, Sub(phase, one));
+
+      // A new sample is drawn at the start of each cycle.
+      Int x = Load(&random_state_[i]);
+      Int next = Xor(x, ShiftLeft<13>(x));
+      next = Xor(next, ShiftRight<17>(next));
+      next = Xor(next, ShiftLeft<5>(next));
+      x = Select(running, x, next);
+      Store(&random_state_[i], x);
+      const Float random = Select(
+          running, Load(&random_value_[i]),
+          Mul(ToFloat(ShiftRight<8>(x)), Set(1.0f / 16777216.0f)));
+      Store(&random_value_[i], random);
+
+      const Int first_half = LessThan(phase, half);
+      const Float triangle = Mul(
+          Set(2.0f), Select(first_half, Sub(half, phase), Sub(phase, half)));
+      const Float square = Select(first_half, zero, one);
+      const Int sine_phase = Add(
+          TruncateUnsigned(Mul(phase, Set(4294967296.0f))),
+          Set(uint32_t{0x80000000}));
+      const Float sine = Add(half, Mul(half, SinePMPoly(sine_phase, zero)));
+
+      const Int waveform = Load(&waveform_[i]);
+      Float value = random;
+      value = Select(Equal(waveform, Set(uint32_t{Lfo::WAVEFORM_TRIANGLE})),
+                     triangle, value);
+      value = Select(Equal(waveform, Set(uint32_t{Lfo::WAVEFORM_RAMP_DOWN})),
+                     Sub(one, phase), value);
+      value = Select(Equal(waveform, Set(uint32_t{Lfo::WAVEFORM_RAMP_UP})),
+                     phase, value);
+      value = Select(Equal(waveform, Set(uint32_t{Lfo::WAVEFORM_SQUARE})),
+                     square, value);
+      value = Select(Equal(waveform, Set(uint32_t{Lfo::WAVEFORM_SINE})), sine,
+                     value);
+      Store(&phase_[i], phase);
+      Store(&value_[i], value);
+
+      Float delay_phase = Load(&delay_phase_[i]);
+      const Float increment =
+          Select(LessThan(delay_phase, half), Load(&delay_increment_[0][i]),
+                 Load(&delay_increment_[1][i]));
+      delay_phase = Min(Add(delay_phase, Mul(s, increment)), one);
+      Store(&delay_phase_[i], delay_phase);
+
+      const Float delay_ramp =
+          Select(LessThan(delay_phase, half), zero,
+                 Mul(Sub(delay_phase, half), Set(2.0f)));
+      Store(&pitch_mod_[i], Mul(Mul(Sub(value, half), delay_ramp),
+                                Load(&pitch_mod_depth_[i])));
+      Store(&amp_mod_[i], Mul(Mul(Sub(one, value), delay_ramp),
+                              Load(&amp_mod_depth_[i])));
+    }
+  }
+
+  inline float value(int lfo) const { return value_[lfo]; }
+  inline float pitch_mod(int lfo) const { return pitch_mod_[lfo]; }
+  inline float amp_mod(int lfo) const { return amp_mod_[lfo]; }
+
+private:
+  void SetModulations(size_t i,
+                      const Patch::ModulationParameters &modulations) {
+    frequency_[i] = LFOFrequency(modulations.rate) * one_hz_;
+
+    float increments[2];
+    LFODelay(modulations.delay, increments);
+    delay_increment_[0][i] = increments[0] * one_hz_;
+    delay_increment_[1][i] = increments[1] * one_hz_;
+
+    waveform_[i] = modulations.waveform;
+    reset_phase_[i] = modulations.reset_phase != 0;
+
+    amp_mod_depth_[i] = float(modulations.amp_mod_depth) * 0.01f;
+
+    pitch_mod_depth_[i] =
+        float(modulations.pitch_mod_depth) * 0.01f *
+        PitchModSensitivity(modulations.pitch_mod_sensitivity);
+  }
+
+  static constexpr float one_hz_ = 1.f / ToySynth::sample_rate;
+
+  std::array<float, kSize> phase_{};
+  std::array<float, kSize> frequency_{};
+  std::array<float, kSize> delay_phase_{};
+  std::array<std::array<float, kSize>, 2> delay_increment_{};
+  std::array<float, kSize> value_{};
+  std::array<float, kSize> random_value_{};
+  std::array<uint32_t, kSize> random_state_{};
+  std::array<float, kSize> amp_mod_depth_{};
+  std::array<float, kSize> pitch_mod_depth_{};
+  std::array<uint32_t, kSize> waveform_{};
+  std::array<bool, kSize> reset_phase_{};
+
+  std::array<float, kSize> pitch_mod_{};
+  std::array<float, kSize> amp_mod_{};
+
+  // Patch followed by each LFO, and number of voices holding it.
+  std::array<const Patch *, kSize> patch_{};
+  std::array<int, kSize> num_users_{};
+};
+
+} // namespace fm
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_FM_LFO_BANK_H_
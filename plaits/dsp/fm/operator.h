@@ -40,12 +40,6 @@ namespace plaits {
 namespace fm {
 
 struct Operator {
-  enum ModulationSource {
-    MODULATION_SOURCE_EXTERNAL = -2,
-    MODULATION_SOURCE_NONE = -1,
-    MODULATION_SOURCE_FEEDBACK = 0
-  };
-
   inline void Reset() {
     phase = 0;
     amplitude = 0.0f;
@@ -55,82 +49,6 @@ struct Operator {
   float amplitude;
 };
 
-typedef void (*RenderFn)(
-    Operator* ops,
-    const float* f,
-    const float* a,
-    float* fb_state,
-    int fb_amount,
-    const float* modulation,
-    float* out,
-    size_t size);
-
-template<int n, int modulation_source, bool additive>
-void RenderOperators(
-    Operator* ops,
-    const float* f,
-    const float* a,
-    float* fb_state,
-    int fb_amount,
-    const float* modulation,
-    float* out,
-    size_t size) {
-  float previous_0, previous_1;
-  
-  if (modulation_source >= Operator::MODULATION_SOURCE_FEEDBACK) {
-    previous_0 = fb_state[0];
-    previous_1 = fb_state[1];
-  }
-
-  uint32_t frequency[n];
-  uint32_t phase[n];
-  float amplitude[n];
-  float amplitude_increment[n];
-
-  const float scale = 1.0f / float(size);
-  for (int i = 0; i < n; ++i) {
-    frequency[i] = static_cast<uint32_t>(std::min(f[i], 0.5f) * 4294967296.0f);
-    phase[i] = ops[i].phase;
-    amplitude[i] = ops[i].amplitude;
-    amplitude_increment[i] = (std::min(a[i], 4.0f) - amplitude[i]) * scale;
-  }
-  
-  const float fb_scale = fb_amount ? float(1 << fb_amount) / 512.0f : 0.0f;
-
-  while (size--) {
-    float pm = 0.0f;
-    if (modulation_source >= Operator::MODULATION_SOURCE_FEEDBACK) {
-      pm = (previous_0 + previous_1) * fb_scale;
-    } else if (modulation_source == Operator::MODULATION_SOURCE_EXTERNAL) {
-      pm = *modulation++;
-    }
-    for (int i = 0; i < n; ++i) {
-      phase[i] += frequency[i];
-      pm = SinePM(phase[i], pm) * amplitude[i];
-      amplitude[i] += amplitude_increment[i];
-      if (i == modulation_source) {
-        previous_1 = previous_0;
-        previous_0 = pm;
-      }
-    }
-    if constexpr (additive) {
-      *out++ += pm;
-    } else {
-      *out++ = pm;
-    }
-  }
-  
-  for (int i = 0; i < n; ++i) {
-    ops[i].phase = phase[i];
-    ops[i].amplitude = amplitude[i];
-  }
-  
-  if (modulation_source >= Operator::MODULATION_SOURCE_FEEDBACK) {
-    fb_state[0] = previous_0;
-    fb_state[1] = previous_1;
-  }
-};
-
 }  // namespace fm
   
 }  // namespace plaits
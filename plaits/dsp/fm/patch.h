@@ -24,7 +24,8 @@
 //
 // -----------------------------------------------------------------------------
 //
-// DX7 patch.
+// DX7 patch. 4-operator patches (DX21, DX100, TX81Z...) are converted to the
+// same structure, using its first 4 operators.
 
 #ifndef PLAITS_DSP_FM_PATCH_H_
 #define PLAITS_DSP_FM_PATCH_H_
@@ -36,8 +37,21 @@ namespace plaits {
 
 namespace fm {
 
+// Frequency ratios of the 4-operator synths (0.50, 0.71, 0.78 ... 25.95),
+// as the DX7 coarse and fine settings closest to them (within 0.1%).
+inline constexpr uint8_t kVMEMFrequencyRatios[64][2] = {
+    {0, 0}, {0, 42}, {0, 56}, {0, 74}, {1, 0}, {1, 41}, {1, 57}, {1, 73},
+    {2, 0}, {2, 41}, {3, 0}, {2, 57}, {2, 73}, {4, 0}, {4, 6}, {3, 57},
+    {5, 0}, {3, 73}, {5, 13}, {6, 0}, {4, 57}, {4, 73}, {7, 0}, {7, 1},
+    {5, 57}, {8, 0}, {8, 6}, {5, 73}, {9, 0}, {6, 57}, {9, 10}, {10, 0},
+    {6, 73}, {7, 57}, {11, 0}, {10, 13}, {12, 0}, {7, 73}, {8, 57}, {12, 6},
+    {13, 0}, {8, 73}, {14, 0}, {10, 41}, {9, 57}, {15, 0}, {14, 11}, {9, 73},
+    {10, 57}, {16, 6}, {11, 57}, {10, 73}, {11, 67}, {12, 57}, {11, 73}, {19, 4},
+    {13, 57}, {12, 73}, {20, 6}, {14, 57}, {13, 73}, {15, 57}, {14, 73}, {15, 73},
+};
+
 struct Patch {
-  enum { SYX_SIZE = 128 };
+  enum { SYX_SIZE = 128, VMEM_SIZE = 128 };
 
   // The layout conveniently matches the 156 bytes SysEx format.
 
@@ -142,6 +156,102 @@ struct Patch {
     }
     active_operators = 0x3f;
   }
+
+  // Unpacks a voice in the 4-operator bulk dump format (VMEM), into op[0] to
+  // op[3] in the order used by Algorithms<4>: OP4, OP3, OP2, OP1. The VMEM
+  // stores them as OP4, OP2, OP3, OP1.
+  //
+  // The 4-operator envelopes (attack, decay 1 to the sustain level, decay 2
+  // towards silence, release) map to the 4 stages of the DX7 envelope; their
+  // rates are scaled to the DX7 range. The TX81Z additions (waveforms, fixed
+  // frequencies, fine ratios) are ignored.
+  constexpr void UnpackVMEM(const uint8_t *data) {
+    constexpr int vmem_order[4] = {0, 2, 1, 3};
+    for (int i = 0; i < 4; ++i) {
+      auto &o = op[i];
+      const uint8_t *op_data = &data[vmem_order[i] * 10];
+      const int attack_rate = op_data[0] & 0x1f;
+      const int decay_1_rate = op_data[1] & 0x1f;
+      const int decay_2_rate = op_data[2] & 0x1f;
+      const int release_rate = op_data[3] & 0xf;
+      const int decay_1_level = op_data[4] & 0xf;
+
+      // 3 dB per step of D1L, 0.75 dB per DX7 level.
+      const int sustain_level =
+          decay_1_level ? 99 - (15 - decay_1_level) * 4 : 0;
+      o.envelope.rate[0] = uint8_t(attack_rate * 99 / 31);
+      o.envelope.rate[1] = uint8_t(decay_1_rate * 99 / 31);
+      o.envelope.rate[2] = uint8_t(decay_2_rate * 99 / 31);
+      o.envelope.rate[3] = uint8_t(std::max(release_rate, 1) * 99 / 15);
+      o.envelope.level[0] = 99;
+      o.envelope.level[1] = uint8_t(sustain_level);
+      o.envelope.level[2] = uint8_t(decay_2_rate ? 0 : sustain_level);
+      o.envelope.level[3] = 0;
+
+      // Level scaling only attenuates the operator towards the high notes.
+      o.keyboard_scaling.break_point = 0;
+      o.keyboard_scaling.left_depth = 0;
+      o.keyboard_scaling.right_depth = std::min(op_data[5] & 0x7f, 99);
+      o.keyboard_scaling.left_curve = 0;
+      o.keyboard_scaling.right_curve = 0;
+
+      const bool amp_mod_enable = op_data[6] & 0x40;
+      o.rate_scaling = uint8_t(((op_data[9] >> 3) & 0x3) * 7 / 3);
+      o.amp_mod_sensitivity =
+          amp_mod_enable ? uint8_t((data[45] >> 2) & 0x3) : 0;
+      o.velocity_sensitivity = op_data[6] & 0x7;
+      o.level = std::min(op_data[7] & 0x7f, 99);
+      o.mode = 0;
+      o.coarse = kVMEMFrequencyRatios[op_data[8] & 0x3f][0];
+      o.fine = kVMEMFrequencyRatios[op_data[8] & 0x3f][1];
+      o.detune = uint8_t(1 + 2 * std::min(op_data[9] & 0x7, 6));
+    }
+    for (int i = 4; i < 6; ++i) {
+      op[i] = Operator{};
+    }
+
+    // The pitch envelope of the DX21 (rates and levels 1 to 3) goes from PL3
+    // to PL1, sustains at PL2, and returns to PL3 on release. It is absent
+    // (all zero) from the other models.
+    const uint8_t *peg = &data[67];
+    const bool has_pitch_envelope =
+        peg[0] || peg[1] || peg[2] || peg[3] || peg[4] || peg[5];
+    for (int j = 0; j < 4; ++j) {
+      pitch_envelope.rate[j] = 99;
+      pitch_envelope.level[j] = 50;
+    }
+    if (has_pitch_envelope) {
+      pitch_envelope.rate[0] = std::min(peg[0] & 0x7f, 99);
+      pitch_envelope.rate[1] = std::min(peg[1] & 0x7f, 99);
+      pitch_envelope.rate[3] = std::min(peg[2] & 0x7f, 99);
+      pitch_envelope.level[0] = std::min(peg[3] & 0x7f, 99);
+      pitch_envelope.level[1] = std::min(peg[4] & 0x7f, 99);
+      pitch_envelope.level[2] = std::min(peg[4] & 0x7f, 99);
+      pitch_envelope.level[3] = std::min(peg[5] & 0x7f, 99);
+    }
+
+    algorithm = data[40] & 0x7;
+    feedback = (data[40] >> 3) & 0x7;
+    // The 4-operator synths restart their oscillators on each note.
+    reset_phase = 1;
+
+    // Sawtooth up, square, triangle, sample & hold.
+    constexpr uint8_t lfo_waveforms[4] = {2, 3, 0, 5};
+    modulations.rate = std::min(data[41] & 0x7f, 99);
+    modulations.delay = std::min(data[42] & 0x7f, 99);
+    modulations.pitch_mod_depth = std::min(data[43] & 0x7f, 99);
+    modulations.amp_mod_depth = std::min(data[44] & 0x7f, 99);
+    modulations.reset_phase = (data[40] >> 6) & 0x1;
+    modulations.waveform = lfo_waveforms[data[45] & 0x3];
+    modulations.pitch_mod_sensitivity = (data[45] >> 4) & 0x7;
+
+    transpose = std::min(data[46] & 0x7f, 48);
+
+    for (size_t i = 0; i < sizeof(name); ++i) {
+      name[i] = data[57 + i] & 0x7f;
+    }
+    active_operators = 0x0f;
+  }
 };
 
 } // namespace fm
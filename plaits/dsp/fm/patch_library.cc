@@ -0,0 +1,252 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+//
+// -----------------------------------------------------------------------------
+//
+// Library of DX7 patches loaded from SysEx files at run time.
+
+#include "plaits/dsp/fm/patch_library.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace plaits {
+
+namespace fm {
+
+using namespace std;
+
+PatchLibrary::PatchLibrary(size_t cache_size) {
+  slots_.resize(std::max(cache_size, size_t(1)));
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    slots_[i].patch = kNone;
+    slots_[i].pins = 0;
+    PushFront(int32_t(i));
+  }
+}
+
+PatchLibrary::~PatchLibrary() {
+  for (const Mapping &m : mappings_) {
+    munmap(m.address, m.size);
+  }
+}
+
+size_t PatchLibrary::AddDirectory(const string &path) {
+  DIR *dir = opendir(path.c_str());
+  if (!dir) {
+    return 0;
+  }
+  vector<string> files;
+  while (const dirent *entry = readdir(dir)) {
+    const string_view name(entry->d_name);
+    if (name.size() > 4) {
+      string extension(name.substr(name.size() - 4));
+      transform(extension.begin(), extension.end(), extension.begin(),
+                [](char c) { return char(tolower(c)); });
+      if (extension == ".syx") {
+        files.emplace_back(path + "/" + entry->d_name);
+      }
+    }
+  }
+  closedir(dir);
+
+  sort(files.begin(), files.end());
+  size_t num_added = 0;
+  for (const string &file : files) {
+    num_added += AddFile(file);
+  }
+  return num_added;
+}
+
+size_t PatchLibrary::AddFile(const string &path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  struct stat st;
+  void *address = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && size_t(st.st_size) >= kBulkDumpSize) {
+    address = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (address == MAP_FAILED) {
+    return 0;
+  }
+
+  const size_t size = st.st_size;
+  const uint8_t *data = static_cast<const uint8_t *>(address);
+  size_t num_added = 0;
+  for (size_t offset = 0; offset + kBulkDumpSize <= size;
+       offset += kBulkDumpSize) {
+    if (IsValidBulkDump(&data[offset])) {
+      AddBank(&data[offset + 6]);
+      num_added += kNumPatchesPerBank;
+    } else {
+      ++num_rejected_banks_;
+    }
+  }
+
+  if (num_added) {
+    mappings_.push_back({address, size});
+  } else {
+    munmap(address, size);
+  }
+  return num_added;
+}
+
+void PatchLibrary::AddBank(const uint8_t *data) {
+  const size_t first = patches_.size();
+  for (size_t i = 0; i < kNumPatchesPerBank; ++i) {
+    patches_.push_back(&data[i * Patch::SYX_SIZE]);
+    slot_of_patch_.push_back(kNone);
+    sorted_.push_back(uint32_t(first + i));
+  }
+
+  // The new patches come after all the others, so a stable merge keeps the
+  // patches with the same name in index order.
+  auto by_name = [this](uint32_t a, uint32_t b) {
+    return this->name(a) < this->name(b);
+  };
+  const auto middle = sorted_.begin() + first;
+  stable_sort(middle, sorted_.end(), by_name);
+  inplace_merge(sorted_.begin(), middle, sorted_.end(), by_name);
+}
+
+bool PatchLibrary::IsValidBulkDump(const uint8_t *data) const {
+  // Yamaha ID, any MIDI channel, 32 voices format, 4096 bytes.
+  if (data[0] != 0xf0 || data[1] != 0x43 || (data[2] & 0xf0) != 0x00 ||
+      data[3] != 0x09 || data[4] != 0x20 || data[5] != 0x00 ||
+      data[kBulkDumpSize - 1] != 0xf7) {
+    return false;
+  }
+  uint8_t sum = 0;
+  for (size_t i = 0; i < kBankSize; ++i) {
+    sum += data[6 + i];
+  }
+  return ((-sum) & 0x7f) == data[6 + kBankSize];
+}
+
+string_view PatchLibrary::name(size_t index) const {
+  const char *name =
+      reinterpret_cast<const char *>(&patches_[index][Patch::SYX_SIZE - kNameSize]);
+  size_t size = kNameSize;
+  while (size && (name[size - 1] == ' ' || name[size - 1] == '\0')) {
+    --size;
+  }
+  return string_view(name, size);
+}
+
+size_t PatchLibrary::Find(string_view name) const {
+  auto it = lower_bound(
+      sorted_.begin(), sorted_.end(), name,
+      [this](uint32_t a, string_view n) { return this->name(a) < n; });
+  return it != sorted_.end() && this->name(*it) == name ? *it : kNotFound;
+}
+
+bool PatchLibrary::Prepare(size_t index) {
+  uint32_t state = prepared_.load();
+  if (state == uint32_t(index)) {
+    return true;
+  }
+  if ((state != kNone && (state & (kPreparing | kTaking))) ||
+      !prepared_.compare_exchange_strong(state, uint32_t(index) | kPreparing)) {
+    return false;
+  }
+  prepared_patch_.patch.Unpack(patches_[index]);
+  prepared_patch_.setup = Voice<6>::PatchSetup::Compute(prepared_patch_.patch);
+  prepared_.store(uint32_t(index));
+  return true;
+}
+
+const PatchLibrary::CachedPatch *PatchLibrary::Acquire(size_t index) {
+  uint32_t s = slot_of_patch_[index];
+  if (s == kNone) {
+    // Recycle the least recently used slot that is not pinned.
+    int32_t victim = tail_;
+    while (victim != -1 && slots_[victim].pins) {
+      victim = slots_[victim].previous;
+    }
+    if (victim == -1) {
+      return NULL;
+    }
+    uint32_t state = uint32_t(index);
+    if (!prepared_.compare_exchange_strong(state, state | kTaking)) {
+      ++num_misses_;
+      return NULL;
+    }
+    Slot &slot = slots_[victim];
+    if (slot.patch != kNone) {
+      slot_of_patch_[slot.patch] = kNone;
+    }
+    slot.patch = uint32_t(index);
+    slot.data = prepared_patch_;
+    prepared_.store(kNone);
+    slot_of_patch_[index] = s = uint32_t(victim);
+  }
+  Unlink(int32_t(s));
+  PushFront(int32_t(s));
+  ++slots_[s].pins;
+  return &slots_[s].data;
+}
+
+void PatchLibrary::Release(size_t index) {
+  const uint32_t s = slot_of_patch_[index];
+  if (s != kNone && slots_[s].pins) {
+    --slots_[s].pins;
+  }
+}
+
+void PatchLibrary::Unlink(int32_t slot) {
+  Slot &s = slots_[slot];
+  if (s.previous != -1) {
+    slots_[s.previous].next = s.next;
+  } else {
+    head_ = s.next;
+  }
+  if (s.next != -1) {
+    slots_[s.next].previous = s.previous;
+  } else {
+    tail_ = s.previous;
+  }
+}
+
+void PatchLibrary::PushFront(int32_t slot) {
+  Slot &s = slots_[slot];
+  s.previous = -1;
+  s.next = head_;
+  if (head_ != -1) {
+    slots_[head_].previous = slot;
+  } else {
+    tail_ = slot;
+  }
+  head_ = slot;
+}
+
+} // namespace fm
+
+} // namespace plaits
@@ -0,0 +1,167 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+//
+// -----------------------------------------------------------------------------
+//
+// Library of DX7 patches loaded from SysEx files at run time.
+//
+// Banks are 32-voice bulk dumps (4104 bytes: F0 43 0n 09 20 00, 4096 bytes of
+// packed voices, checksum, F7). A .syx file may hold several consecutive
+// banks. Files are memory-mapped rather than read, so that a library of
+// thousands of patches costs one pointer per patch until a patch is played.
+//
+// Patches are unpacked, and their fm::Voice<6>::PatchSetup computed, by
+// Prepare(), outside of the audio callback. Acquire() then moves the prepared
+// patch into one of a fixed number of cache slots, recycled in
+// least-recently-used order. A voice playing a patch pins its slot, so that it
+// is not recycled under its feet.
+//
+// Adding files allocates and must be done outside of the audio callback, while
+// nothing else uses the library. Prepare() can be called from another thread
+// than the audio callback; Acquire() and Release() never allocate nor compute
+// a patch setup, and are meant for the audio callback. A patch that is neither
+// cached nor prepared is a cache miss.
+
+#ifndef PLAITS_DSP_FM_PATCH_LIBRARY_H_
+#define PLAITS_DSP_FM_PATCH_LIBRARY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "plaits/dsp/fm/patch.h"
+#include "plaits/dsp/fm/voice.h"
+
+namespace plaits {
+
+namespace fm {
+
+class PatchLibrary {
+public:
+  static constexpr size_t kNumPatchesPerBank = 32;
+  static constexpr size_t kBankSize = kNumPatchesPerBank * Patch::SYX_SIZE;
+  static constexpr size_t kBulkDumpSize = kBankSize + 8;
+  static constexpr size_t kNameSize = 10;
+  static constexpr size_t kDefaultCacheSize = 64;
+  static constexpr size_t kNotFound = ~size_t(0);
+
+  struct CachedPatch {
+    Patch patch;
+    Voice<6>::PatchSetup setup;
+  };
+
+  explicit PatchLibrary(size_t cache_size = kDefaultCacheSize);
+  ~PatchLibrary();
+
+  PatchLibrary(const PatchLibrary &) = delete;
+  PatchLibrary &operator=(const PatchLibrary &) = delete;
+
+  // Adds all the .syx files in a directory (not recursively), in alphabetical
+  // order. Returns the number of patches added.
+  size_t AddDirectory(const std::string &path);
+
+  // Adds the banks found in a SysEx file. Returns the number of patches added;
+  // banks with a bad header or checksum are skipped and counted as rejected.
+  size_t AddFile(const std::string &path);
+
+  // Adds a bank already in memory, without header (as in fm_patch_sysex.hh).
+  // The data must outlive the library.
+  void AddBank(const uint8_t *data);
+
+  inline size_t size() const { return patches_.size(); }
+  inline size_t num_rejected_banks() const { return num_rejected_banks_; }
+
+  // The name of a patch, without its trailing spaces.
+  std::string_view name(size_t index) const;
+
+  // Index of the first patch with this name, or kNotFound. The index is built
+  // when banks are added, so this does not modify the library.
+  size_t Find(std::string_view name) const;
+
+  // Unpacks a patch and computes its setup, for the next Acquire() of this
+  // patch. Only one patch is prepared at a time: preparing another one
+  // replaces it. Returns false if the audio callback is taking the prepared
+  // patch, or another thread is preparing one.
+  bool Prepare(size_t index);
+
+  // Returns the unpacked patch, and pins it in the cache until the matching
+  // Release(). Returns NULL if the patch is neither cached nor prepared, or if
+  // every slot of the cache is pinned.
+  const CachedPatch *Acquire(size_t index);
+  void Release(size_t index);
+
+  inline size_t cache_size() const { return slots_.size(); }
+  inline size_t num_misses() const { return num_misses_; }
+
+private:
+  struct Slot {
+    CachedPatch data;
+    // Index of the cached patch, or kNone.
+    uint32_t patch;
+    // Number of Acquire() calls not yet released.
+    uint32_t pins;
+    // Doubly-linked list of the slots, from most to least recently used.
+    int32_t previous;
+    int32_t next;
+  };
+
+  struct Mapping {
+    void *address;
+    size_t size;
+  };
+
+  static constexpr uint32_t kNone = ~uint32_t(0);
+  // Flags of prepared_, while prepared_patch_ is being written or read.
+  static constexpr uint32_t kPreparing = 1u << 31;
+  static constexpr uint32_t kTaking = 1u << 30;
+
+  bool IsValidBulkDump(const uint8_t *data) const;
+  void Unlink(int32_t slot);
+  void PushFront(int32_t slot);
+
+  std::vector<const uint8_t *> patches_;
+  // Cache slot of each patch, or kNone.
+  std::vector<uint32_t> slot_of_patch_;
+  // Patch indices sorted by name, and by index for equal names.
+  std::vector<uint32_t> sorted_;
+  std::vector<Mapping> mappings_;
+  std::vector<Slot> slots_;
+
+  // Index of the patch in prepared_patch_, or kNone, with the flags above.
+  std::atomic<uint32_t> prepared_{kNone};
+  CachedPatch prepared_patch_{};
+
+  int32_t head_{-1};
+  int32_t tail_{-1};
+  size_t num_rejected_banks_{};
+  size_t num_misses_{};
+};
+
+} // namespace fm
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_FM_PATCH_LIBRARY_H_
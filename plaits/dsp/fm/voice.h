@@ -36,6 +36,7 @@
 #include "plaits/dsp/fm/dx_units.h"
 #include "plaits/dsp/fm/envelope.h"
 #include "plaits/dsp/fm/patch.h"
+#include "plaits/dsp/simd.h"
 #include <array>
 
 // When enabled, the amplitude modulation LFO linearly modulates the amplitude
@@ -62,6 +63,45 @@ public:
     float amp_mod{};
   };
 
+  // Everything that can be pre-computed once a patch is known: envelope
+  // shapes, level headroom and frequency ratios. Setups for the built-in
+  // banks are computed at compile time; patches loaded at run time must have
+  // theirs computed outside of the audio callback.
+  struct PatchSetup {
+    EnvelopeShape<4> pitch_envelope;
+    std::array<EnvelopeShape<4>, num_operators> operator_envelope;
+
+    // The level increase caused by keyboard scaling plus velocity scaling
+    // should not exceed this number - otherwise it would be equivalent to
+    // have an operator with a level above 99.
+    std::array<float, num_operators> level_headroom;
+
+    // Frequency ratios. The base frequency (1Hz or the root note) is encoded
+    // as the sign of the ratio.
+    std::array<float, num_operators> ratios;
+
+    std::array<float, num_operators> amp_mod_sensitivity;
+
+    static constexpr PatchSetup Compute(const Patch &patch) {
+      PatchSetup setup{};
+      setup.pitch_envelope = PitchEnvelope<envelope_scale>::ComputeShape(
+          patch.pitch_envelope.rate, patch.pitch_envelope.level);
+      for (int i = 0; i < num_operators; ++i) {
+        const Patch::Operator &op = patch.op[i];
+        const int level = OperatorLevel(op.level);
+        setup.operator_envelope[i] =
+            OperatorEnvelope<envelope_scale>::ComputeShape(
+                op.envelope.rate, op.envelope.level, level);
+        setup.level_headroom[i] = float(127 - level);
+        const float sign = op.mode == 0 ? 1.0f : -1.0f;
+        setup.ratios[i] = sign * FrequencyRatio(op);
+        setup.amp_mod_sensitivity[i] =
+            AmpModSensitivity(op.amp_mod_sensitivity);
+      }
+      return setup;
+    }
+  };
+
   inline void Init(const Algorithms<num_operators> *algorithms) {
     algorithms_ = algorithms;
 
@@ -70,65 +110,203 @@ public:
     }
 
     patch_ = NULL;
+    setup_ = NULL;
   }
 
-  inline void SetPatch(const Patch *patch) {
+  // Switching patches only swaps pointers, so it can be done at any time in
+  // the audio callback. Both objects must outlive their use by the voice.
+  inline void SetPatch(const Patch *patch, const PatchSetup *setup) {
     patch_ = patch;
-    dirty_ = true;
+    setup_ = setup;
+    scaling_dirty_ = true;
+    pitch_envelope_.Set(&setup->pitch_envelope);
+    for (int i = 0; i < num_operators; ++i) {
+      operator_envelope_[i].Set(&setup->operator_envelope[i]);
+    }
   }
 
-  // Pre-compute everything that can be pre-computed once a patch is loaded:
-  // - envelope constants
-  // - frequency ratios
-  inline bool Setup() {
-    if (!dirty_) {
-      return false;
+  inline float op_level(int i) const { return level_[i]; }
+
+  // Adds the voice's output to out.
+  inline void Render(const Parameters &parameters, float *out, size_t size) {
+    float f[num_operators];
+    float a[kNumControls];
+    Controls controls{};
+    if (!Prepare(parameters, size, 0, 1, f, &controls)) {
+      return;
+    }
+    ComputeAmplitudes(&controls, num_operators, a);
+    for (int i = 0; i < num_operators; ++i) {
+      level_[i] = controls.level[i];
     }
+    (*algorithms_->render_fn(patch_->algorithm))(
+        operator_.data(), f, a, feedback_state_.data(), patch_->feedback, out,
+        size);
+  }
 
-    pitch_envelope_.Set(patch_->pitch_envelope.rate,
-                        patch_->pitch_envelope.level);
+  // Renders simd::kNumLanes voices at once, one per lane. All the voices must
+  // use the same algorithm; voices[l] can be NULL for an unused lane. temp
+  // must hold size * simd::kNumLanes floats. The output of voice l is added
+  // to out[l].
+  static void RenderLanes(Voice *const *voices, const Parameters *parameters,
+                          float *temp, float *const *out, size_t size) {
+    constexpr size_t lanes = simd::kNumLanes;
+
+    float f[num_operators * lanes] = {};
+    float a[num_operators * lanes];
+    Controls controls{};
+    float fb_state[2 * lanes];
+    int fb_amount[lanes];
+    Operator *ops[lanes];
+    bool active[lanes];
+
+    // Unused lanes render silence from a scratch set of operators.
+    Operator idle[num_operators];
     for (int i = 0; i < num_operators; ++i) {
-      const Patch::Operator &op = patch_->op[i];
+      idle[i].Reset();
+    }
 
-      int level = OperatorLevel(op.level);
-      operator_envelope_[i].Set(op.envelope.rate, op.envelope.level, level);
+    const Voice *leader = NULL;
+    for (size_t l = 0; l < lanes; ++l) {
+      Voice *voice = voices[l];
+      active[l] =
+          voice && voice->Prepare(parameters[l], size, l, lanes, f, &controls);
+      if (active[l]) {
+        leader = voice;
+        ops[l] = voice->operator_.data();
+        fb_amount[l] = voice->patch_->feedback;
+        fb_state[l] = voice->feedback_state_[0];
+        fb_state[lanes + l] = voice->feedback_state_[1];
+      } else {
+        ops[l] = idle;
+        fb_amount[l] = 0;
+        fb_state[l] = fb_state[lanes + l] = 0.0f;
+      }
+    }
+    if (!leader) {
+      return;
+    }
 
-      // The level increase caused by keyboard scaling plus velocity
-      // scaling should not exceed this number - otherwise it would be
-      // equivalent to have an operator with a level above 99.
-      level_headroom_[i] = float(127 - level);
+    ComputeAmplitudes(&controls, num_operators * lanes, a);
+    for (size_t l = 0; l < lanes; ++l) {
+      for (int i = 0; i < num_operators; ++i) {
+        if (active[l]) {
+          voices[l]->level_[i] = controls.level[i * lanes + l];
+        } else {
+          a[i * lanes + l] = 0.0f;
+        }
+      }
+    }
+
+    std::fill(&temp[0], &temp[size * lanes], 0.0f);
+    (*leader->algorithms_->render_lanes_fn(leader->patch_->algorithm))(
+        ops, f, a, fb_state, fb_amount, temp, size);
 
-      // Pre-compute frequency ratios. Encode the base frequency
-      // (1Hz or the root note) as the sign of the ratio.
-      float sign = op.mode == 0 ? 1.0f : -1.0f;
-      ratios_[i] = sign * FrequencyRatio(op);
+    for (size_t l = 0; l < lanes; ++l) {
+      if (!active[l]) {
+        continue;
+      }
+      voices[l]->feedback_state_[0] = fb_state[l];
+      voices[l]->feedback_state_[1] = fb_state[lanes + l];
+      for (size_t t = 0; t < size; ++t) {
+        out[l][t] += temp[t * lanes + l];
+      }
+    }
+  }
+
+  inline const Patch *patch() const { return patch_; }
+
+  // True once the voice has been released and its carriers have decayed
+  // below -80 dB, so that rendering it can be skipped.
+  inline bool idle() const {
+    if (!patch_) {
+      return true;
+    }
+    if (gate_) {
+      return false;
+    }
+    for (int i = 0; i < num_operators; ++i) {
+      if (!algorithms_->is_modulator(patch_->algorithm, i) &&
+          operator_[i].amplitude > 1e-4f) {
+        return false;
+      }
     }
-    dirty_ = false;
     return true;
   }
 
-  inline float op_level(int i) const { return level_[i]; }
+private:
+  // The operator levels are computed in two steps. Prepare() runs the
+  // envelopes and gathers, for each operator, everything the level and
+  // amplitude depend on. ComputeAmplitudes() then does the arithmetic for all
+  // the operators (and voices, in RenderLanes()) in SIMD. Element i * stride
+  // + lane holds operator i of the voice in the given lane; the size is
+  // rounded up to a whole number of vectors.
+  static constexpr size_t kNumControls =
+      (num_operators * simd::kNumLanes + simd::kNumLanes - 1) /
+      simd::kNumLanes * simd::kNumLanes;
+
+  struct Controls {
+    float envelope[kNumControls];
+    // Keyboard, velocity and brightness scaling, before headroom clipping.
+    float scaling[kNumControls];
+    float headroom[kNumControls];
+    float amp_mod_sensitivity[kNumControls];
+    float amp_mod[kNumControls];
+    float level[kNumControls];
+  };
 
-  inline void Render(const Parameters &parameters, float *temp, float *out,
-                     float *aux, size_t size) {
-    float *buffers[4] = {out, aux, temp, temp};
-    Render(parameters, buffers, size);
+  // Same as level += 0.125 * min(scaling, headroom) and the amplitude formula
+  // that follows, for n elements.
+  static inline void ComputeAmplitudes(Controls *c, size_t n, float *a) {
+    using namespace simd;
+    for (size_t k = 0; k < n; k += kNumLanes) {
+      const Float scaling =
+          Min(Load(&c->scaling[k]), Load(&c->headroom[k]));
+      const Float level =
+          Add(Load(&c->envelope[k]), Mul(Set(0.125f), scaling));
+      Store(&c->level[k], level);
+      const Float sensitivity = Load(&c->amp_mod_sensitivity[k]);
+      const Float amp_mod = Load(&c->amp_mod[k]);
+#ifdef FAST_OP_LEVEL_MODULATION
+      const Float level_mod = Sub(Set(1.0f), Mul(sensitivity, amp_mod));
+      const Float amplitude =
+          Mul(Pow2Fast<2>(Add(Set(-14.0f), level)), level_mod);
+#else
+      const Float log_level_mod = Sub(Mul(sensitivity, amp_mod), Set(1.0f));
+      const Float level_mod =
+          Sub(Set(1.0f), Pow2Fast<2>(Mul(Set(6.4f), log_level_mod)));
+      const Float amplitude =
+          Pow2Fast<2>(Add(Set(-14.0f), Mul(level, level_mod)));
+#endif // FAST_OP_LEVEL_MODULATION
+      if (k + kNumLanes <= n) {
+        Store(&a[k], amplitude);
+      } else {
+        float tail[kNumLanes];
+        Store(tail, amplitude);
+        std::copy(&tail[0], &tail[n - k], &a[k]);
+      }
+    }
   }
 
-  inline void Render(const Parameters &parameters, float *temp, size_t size) {
-    float *buffers[4] = {temp, temp + size, temp + 2 * size, temp + 2 * size};
-    Render(parameters, buffers, size);
+  // Rate and level scaling only change with the note, velocity and patch.
+  inline void UpdateScaling() {
+    for (int i = 0; i < num_operators; ++i) {
+      const Patch::Operator &op = patch_->op[i];
+      rate_scaling_[i] = RateScaling(note_, op.rate_scaling);
+      const float kb_scaling = KeyboardScaling(note_, op.keyboard_scaling);
+      const float velocity_scaling =
+          normalized_velocity_ * float(op.velocity_sensitivity);
+      level_scaling_[i] = kb_scaling + velocity_scaling;
+    }
+    scaling_dirty_ = false;
   }
 
-  inline void Render(const Parameters &parameters, float *buffers[4],
-                     size_t size) {
-    if (Setup()) {
-      // This prevents a CPU overrun, since there is not enough CPU to perform
-      // both a patch setup and a full render in the time alloted for
-      // a render. As a drawback, this causes a 0.5ms blank before a new
-      // patch starts playing. But this is a clean blank, as opposed to a
-      // glitchy overrun.
-      return;
+  // Computes the frequency of each operator for the next block, and fills
+  // its entries in c. Returns false when there is nothing to render.
+  inline bool Prepare(const Parameters &parameters, size_t size, size_t lane,
+                      size_t stride, float *f, Controls *c) {
+    if (!patch_) {
+      return false;
     }
 
     const float envelope_rate = float(size);
@@ -157,6 +335,10 @@ public:
     if (note_on || parameters.sustain) {
       normalized_velocity_ = NormalizeVelocity(parameters.velocity);
       note_ = parameters.note;
+      scaling_dirty_ = true;
+    }
+    if (scaling_dirty_) {
+      UpdateScaling();
     }
 
     // Reset operator phase if a note on is detected & if the patch requires it.
@@ -166,55 +348,30 @@ public:
       }
     }
 
-    // Compute frequencies and amplitudes.
-    float f[num_operators];
-    float a[num_operators];
+    const float brightness = (parameters.brightness - 0.5f) * 32.0f;
     for (int i = 0; i < num_operators; ++i) {
-      const Patch::Operator &op = patch_->op[i];
-
-      f[i] = ratios_[i] * (ratios_[i] < 0.0f ? -one_hz_ : f0);
-
-      const float rate_scaling = RateScaling(note_, op.rate_scaling);
-      float level = parameters.sustain
-                        ? operator_envelope_[i].RenderAtSample(envelope_sample,
-                                                               gate_duration)
-                        : operator_envelope_[i].Render(
-                              parameters.gate, envelope_rate * rate_scaling,
-                              ad_scale, r_scale);
-      const float kb_scaling = KeyboardScaling(note_, op.keyboard_scaling);
-      const float velocity_scaling =
-          normalized_velocity_ * float(op.velocity_sensitivity);
-      const float brightness = algorithms_->is_modulator(patch_->algorithm, i)
-                                   ? (parameters.brightness - 0.5f) * 32.0f
-                                   : 0.0f;
-
-      level += 0.125f * std::min(kb_scaling + velocity_scaling + brightness,
-                                 level_headroom_[i]);
-
-      level_[i] = level;
-
-      const float sensitivity = AmpModSensitivity(op.amp_mod_sensitivity);
-#ifdef FAST_OP_LEVEL_MODULATION
-      const float level_mod = 1.0f - sensitivity * parameters.amp_mod;
-      a[i] = Pow2Fast<2>(-14.0f + level) * level_mod;
-#else
-      const float log_level_mod = sensitivity * parameters.amp_mod - 1.0f;
-      const float level_mod = 1.0f - Pow2Fast<2>(6.4f * log_level_mod);
-      a[i] = Pow2Fast<2>(-14.0f + level * level_mod);
-#endif // FAST_LINEAR_AMPLITUDE_MODULATION
-    }
-
-    for (int i = 0; i < num_operators;) {
-      const typename Algorithms<num_operators>::RenderCall &call =
-          algorithms_->render_call(patch_->algorithm, i);
-      (*call.render_fn)(&operator_[i], &f[i], &a[i], feedback_state_.data(),
-                        patch_->feedback, buffers[call.input_index],
-                        buffers[call.output_index], size);
-      i += call.n;
+      const size_t k = i * stride + lane;
+      const float ratio = setup_->ratios[i];
+      f[k] = ratio * (ratio < 0.0f ? -one_hz_ : f0);
+
+      c->envelope[k] =
+          parameters.sustain
+              ? operator_envelope_[i].RenderAtSample(envelope_sample,
+                                                     gate_duration)
+              : operator_envelope_[i].Render(parameters.gate,
+                                             envelope_rate * rate_scaling_[i],
+                                             ad_scale, r_scale);
+      c->scaling[k] = level_scaling_[i] +
+                      (algorithms_->is_modulator(patch_->algorithm, i)
+                           ? brightness
+                           : 0.0f);
+      c->headroom[k] = setup_->level_headroom[i];
+      c->amp_mod_sensitivity[k] = setup_->amp_mod_sensitivity[i];
+      c->amp_mod[k] = parameters.amp_mod;
     }
+    return true;
   }
 
-private:
   const Algorithms<num_operators> *algorithms_;
   static constexpr float one_hz_ = 1.f / sample_rate_;
   static constexpr float a0_ = 55.f / sample_rate_;
@@ -231,15 +388,15 @@ private:
   float normalized_velocity_{10.f};
   float note_{48.f};
 
-  std::array<float, num_operators> ratios_{};
-  std::array<float, num_operators> level_headroom_{};
   std::array<float, num_operators> level_{};
+  std::array<float, num_operators> rate_scaling_{};
+  std::array<float, num_operators> level_scaling_{};
+  bool scaling_dirty_{true};
 
   std::array<float, 2> feedback_state_{};
 
   const Patch *patch_;
-
-  bool dirty_{true};
+  const PatchSetup *setup_;
 };
 
 } // namespace fm
@@ -32,17 +32,19 @@
 #include "stmlib/stmlib.h"
 
 #include "plaits/dsp/fx/fx_engine.h"
-#include <array>
 
 namespace plaits {
 
 class Diffuser {
 public:
+  // Size of the delay memory, in 12-bit samples.
+  static constexpr size_t kBufferSize = 8192;
+
   Diffuser() {}
   ~Diffuser() {}
 
-  void Init() {
-    engine_.Init(buf.data());
+  void Init(uint16_t *buffer) {
+    engine_.Init(buffer);
     engine_.SetLFOFrequency(LFO_1, 0.3f / 48000.0f);
     lp_decay_ = 0.0f;
   }
@@ -96,8 +98,7 @@ public:
   }
 
 private:
-  typedef FxEngine<8192, FORMAT_12_BIT> E;
-  std::array<uint16_t, 8192> buf;
+  typedef FxEngine<kBufferSize, FORMAT_12_BIT> E;
   E engine_;
   float lp_decay_;
 
@@ -26,6 +26,17 @@
 //
 // Simple sine oscillator (wavetable) + fast sine oscillator (magic circle).
 //
+// SinePM() comes in two flavours: an interpolated lookup in lut_sine, and
+// SinePMPoly(), a polynomial with no memory access (no gathers when
+// vectorised). Against sin() in double precision (see TestSinePMAccuracy):
+//
+//                 max error    SNR, FM with index 0.5 to 16
+//   lut_sine      1.9e-5       97 dB
+//   polynomial    2.2e-7       143 dB
+//
+// The polynomial has a higher throughput, but a longer latency, which
+// dominates in chains of operators modulating each other.
+//
 // The fast implementation might glitch a bit under heavy modulations of the
 // frequency.
 
@@ -36,6 +47,10 @@
 #include "stmlib/dsp/parameter_interpolator.h"
 #include "stmlib/dsp/rsqrt.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "plaits/dsp/simd.h"
 #include "plaits/resources.h"
 
 namespace plaits {
@@ -71,6 +86,73 @@ inline float SinePM(uint32_t phase, float pm) {
   return a + (b - a) * fractional;
 }
 
+// SinePM for simd::kNumLanes phases at once. Same output as the scalar version
+// as long as pm >= -16.
+inline simd::Float SinePM(simd::Int phase, simd::Float pm) {
+  using namespace simd;
+  const int max_index_bits = 5;
+  const float offset = float(1 << max_index_bits);
+  const float scale = 4294967296.0f / float(2 << max_index_bits);
+
+  phase = Add(phase, ShiftLeft<max_index_bits + 1>(
+      TruncateUnsigned(Mul(Add(pm, Set(offset)), Set(scale)))));
+
+  const Int integral = ShiftRight<32 - kSineLUTBits>(phase);
+  const Float fractional = Mul(
+      ToFloat(ShiftRight<kSineLUTBits>(ShiftLeft<kSineLUTBits>(phase))),
+      Set(1.0f / float(1 << (32 - kSineLUTBits))));
+  const Float a = Lookup(lut_sine, integral);
+  const Float b = Lookup(lut_sine + 1, integral);
+  return Add(a, Mul(Sub(b, a), fractional));
+}
+
+// Odd minimax polynomial for sin(2 pi x) on [0, 1/4]. With these coefficients,
+// the error is 4.9e-8, and 2.2e-7 once evaluated in single precision.
+inline constexpr float kSinePoly[5] = {
+    6.28318516f, -41.341655f, 81.6010041f, -76.5497823f, 39.5367061f};
+
+// SinePM() without the lookup table. The phase wraps to x in [-1/2, 1/2)
+// turns, which is folded on [0, 1/4] using the symmetries of the sine.
+inline float SinePMPoly(uint32_t phase, float pm) {
+  const float max_uint32 = 4294967296.0f;
+  const int max_index = 32;
+  const float offset = float(max_index);
+  const float scale = max_uint32 / float(max_index * 2);
+
+  phase += static_cast<uint32_t>((pm + offset) * scale) * max_index * 2;
+
+  const float x = static_cast<float>(static_cast<int32_t>(phase)) / max_uint32;
+  const float abs_x = fabsf(x);
+  const float f = std::min(abs_x, 0.5f - abs_x);
+  // Estrin's scheme, for a shorter dependency chain than Horner's.
+  const float f2 = f * f;
+  const float f4 = f2 * f2;
+  const float low = kSinePoly[0] + f2 * kSinePoly[1];
+  const float high = (kSinePoly[2] + f2 * kSinePoly[3]) + f4 * kSinePoly[4];
+  return std::copysign(f * (low + f4 * high), x);
+}
+
+inline simd::Float SinePMPoly(simd::Int phase, simd::Float pm) {
+  using namespace simd;
+  const int max_index_bits = 5;
+  const float offset = float(1 << max_index_bits);
+  const float scale = 4294967296.0f / float(2 << max_index_bits);
+
+  phase = Add(phase, ShiftLeft<max_index_bits + 1>(
+      TruncateUnsigned(Mul(Add(pm, Set(offset)), Set(scale)))));
+
+  const Float x = Mul(ToFloat(phase), Set(1.0f / 4294967296.0f));
+  const Int sign = And(AsInt(x), Set(uint32_t{0x80000000}));
+  const Float abs_x = AsFloat(Xor(AsInt(x), sign));
+  const Float f = Min(abs_x, Sub(Set(0.5f), abs_x));
+  const Float f2 = Mul(f, f);
+  const Float f4 = Mul(f2, f2);
+  const Float low = Add(Set(kSinePoly[0]), Mul(f2, Set(kSinePoly[1])));
+  const Float high = Add(Add(Set(kSinePoly[2]), Mul(f2, Set(kSinePoly[3]))),
+                         Mul(f4, Set(kSinePoly[4])));
+  return AsFloat(Xor(AsInt(Mul(f, Add(low, Mul(f4, high)))), sign));
+}
+
 // Direct lookup without interpolation.
 inline float SineRaw(uint32_t phase) {
   return lut_sine[phase >> (32 - kSineLUTBits)];
@@ -25,26 +25,42 @@
 // -----------------------------------------------------------------------------
 //
 // Delay line (same implementation as from stmlib, but does not own its buffer).
+//
+// The capacity is rounded up to a power of two so that every tap is a mask
+// rather than a modulo. A mirrored line writes each sample twice, kCapacity
+// apart, so that the taps of an interpolated read are contiguous and never
+// wrap: one mask per read instead of one per tap, at twice the memory.
 
 #ifndef PLAITS_DSP_PHYSICAL_MODELLING_DELAY_LINE_H_
 #define PLAITS_DSP_PHYSICAL_MODELLING_DELAY_LINE_H_
 
 #include "stmlib/dsp/dsp.h"
 #include <array>
+#include <bit>
 
 namespace plaits {
 
-template <typename T, size_t max_delay> class DelayLine {
+template <typename T, size_t max_delay, bool mirrored = false>
+class DelayLine {
 public:
+  static constexpr size_t kCapacity = std::bit_ceil(max_delay);
+  static constexpr size_t kMask = kCapacity - 1;
+
+  static_assert(!mirrored || kCapacity >= 4,
+                "A mirrored delay line needs room for 4 Hermite taps");
+
   void Reset() { write_ptr_ = 0; }
 
   inline void Write(const T sample) {
     line_[write_ptr_] = sample;
-    write_ptr_ = (write_ptr_ - 1 + max_delay) % max_delay;
+    if constexpr (mirrored) {
+      line_[write_ptr_ + kCapacity] = sample;
+    }
+    write_ptr_ = (write_ptr_ - 1) & kMask;
   }
 
   inline const T Allpass(const T sample, size_t delay, const T coefficient) {
-    T read = line_[(write_ptr_ + delay) % max_delay];
+    T read = line_[(write_ptr_ + delay) & kMask];
     T write = sample + coefficient * read;
     Write(write);
     return -write * coefficient + read;
@@ -57,18 +73,35 @@ public:
 
   inline const T Read(float delay) const {
     MAKE_INTEGRAL_FRACTIONAL(delay)
-    const T a = line_[(write_ptr_ + delay_integral) % max_delay];
-    const T b = line_[(write_ptr_ + delay_integral + 1) % max_delay];
+    const size_t t = write_ptr_ + delay_integral;
+    T a, b;
+    if constexpr (mirrored) {
+      const T *x = &line_[t & kMask];
+      a = x[0];
+      b = x[1];
+    } else {
+      a = line_[t & kMask];
+      b = line_[(t + 1) & kMask];
+    }
     return a + (b - a) * T(delay_fractional);
   }
 
   inline const T ReadHermite(float delay) const {
     MAKE_INTEGRAL_FRACTIONAL(delay)
-    int32_t t = (write_ptr_ + delay_integral + max_delay);
-    const T xm1 = line_[(t - 1) % max_delay];
-    const T x0 = line_[(t) % max_delay];
-    const T x1 = line_[(t + 1) % max_delay];
-    const T x2 = line_[(t + 2) % max_delay];
+    const size_t t = write_ptr_ + delay_integral;
+    T xm1, x0, x1, x2;
+    if constexpr (mirrored) {
+      const T *x = &line_[(t - 1) & kMask];
+      xm1 = x[0];
+      x0 = x[1];
+      x1 = x[2];
+      x2 = x[3];
+    } else {
+      xm1 = line_[(t - 1) & kMask];
+      x0 = line_[t & kMask];
+      x1 = line_[(t + 1) & kMask];
+      x2 = line_[(t + 2) & kMask];
+    }
     const T c = (x1 - xm1) * 0.5f;
     const T v = x0 - x1;
     const T w = c + v;
@@ -80,9 +113,12 @@ public:
 
 private:
   size_t write_ptr_{};
-  std::array<T, max_delay> line_{};
+  std::array<T, mirrored ? 2 * kCapacity : kCapacity> line_{};
 };
 
+template <typename T, size_t max_delay>
+using MirroredDelayLine = DelayLine<T, max_delay, true>;
+
 } // namespace plaits
 
 #endif // PLAITS_DSP_PHYSICAL_MODELLING_DELAY_LINE_H_
@@ -43,6 +43,11 @@ public:
               float structure, float brightness, float damping, float *temp,
               float *out, float *aux, size_t size);
 
+  void set_max_num_modes(int max_num_modes) {
+    resonator_.set_max_num_modes(max_num_modes);
+  }
+  inline int max_num_modes() const { return resonator_.max_num_modes(); }
+
 private:
   ResonatorSvf<1> excitation_filter_{};
   Resonator resonator_{};
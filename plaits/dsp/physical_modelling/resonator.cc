@@ -30,6 +30,7 @@
 
 #include <algorithm>
 #include <print>
+#include <utility>
 
 #include "stmlib/dsp/cosine_oscillator.h"
 #include "stmlib/dsp/dsp.h"
@@ -58,6 +59,26 @@ inline float NthHarmonicCompensation(int n, float stiffness) {
 void Resonator::Process(float f0, float structure, float brightness,
                         float damping, const float *in, float *out,
                         size_t size) {
+  using Cache = CoefficientCache<4>;
+  if (coefficients_.Miss({Cache::Frequency(f0), Cache::Unit(structure),
+                          Cache::Unit(brightness), Cache::Unit(damping)})) {
+    ComputeModes(f0, structure, brightness, damping);
+  }
+
+#if defined(__SSE2__) || defined(__AVX2__)
+  [&]<size_t... n>(index_sequence<n...>) {
+    ((num_vectors_ == n + 1 && (ProcessModes<n + 1>(in, out, size), true)) ||
+     ...);
+  }(make_index_sequence<kMaxNumVectors>());
+#else
+  // The emulated vectors do not stay in registers, so the modes are rendered
+  // by batches of scalar SVFs instead, each batch in its own pass.
+  ProcessModeBatches(in, out, size);
+#endif // __SSE2__ || __AVX2__
+}
+
+void Resonator::ComputeModes(float f0, float structure, float brightness,
+                             float damping) {
   float stiffness = Interpolate(lut_stiffness, structure, 64.0f);
   f0 *= NthHarmonicCompensation(3, stiffness);
 
@@ -69,31 +90,31 @@ void Resonator::Process(float f0, float structure, float brightness,
   brightness *= 1.0f - damping * 0.3f;
   float q_loss = brightness * (2.0f - brightness) * 0.85f + 0.15f;
 
-  float mode_q[kModeBatchSize];
-  float mode_f[kModeBatchSize];
-  float mode_a[kModeBatchSize];
-  int batch_counter = 0;
+  // Only the modes up to the last audible one are rendered.
+  int num_modes = 0;
 
-  auto batch_processor = &mode_filters_[0];
-
-  for (int i = 0; i < resolution_; ++i) {
+  for (int i = 0; i < max_num_modes_; ++i) {
     float mode_frequency = harmonic * stretch_factor;
+    float mode_gain = 0.0f;
     if (mode_frequency >= 0.499f) {
       mode_frequency = 0.499f;
+    } else {
+      const float mode_attenuation = 1.0f - mode_frequency * 2.0f;
+      mode_gain = mode_amplitude_[i] * mode_attenuation;
     }
-    const float mode_attenuation = 1.0f - mode_frequency * 2.0f;
-
-    mode_f[batch_counter] = mode_frequency;
-    mode_q[batch_counter] = 1.0f + mode_frequency * q;
-    mode_a[batch_counter] = mode_amplitude_[i] * mode_attenuation;
-    ++batch_counter;
-
-    if (batch_counter == kModeBatchSize) {
-      batch_counter = 0;
-      batch_processor->Process<FILTER_MODE_BAND_PASS, true>(
-          mode_f, mode_q, mode_a, in, out, size);
-      ++batch_processor;
+    if (mode_gain >= kModeGainThreshold) {
+      num_modes = i + 1;
+    } else {
+      mode_gain = 0.0f;
     }
+    const float mode_q = 1.0f + mode_frequency * q;
+
+    const float g = OnePole::tan<FREQUENCY_FAST>(mode_frequency);
+    const float r = 1.0f / mode_q;
+    mode_g_[i] = g;
+    mode_r_plus_g_[i] = r + g;
+    mode_h_[i] = 1.0f / (1.0f + r * g + g * g);
+    mode_a_[i] = mode_gain;
 
     stretch_factor += stiffness;
     if (stiffness < 0.0f) {
@@ -106,6 +127,109 @@ void Resonator::Process(float f0, float structure, float brightness,
     harmonic += f0;
     q *= q_loss;
   }
+
+  num_vectors_ = (num_modes + simd::kNumLanes - 1) / simd::kNumLanes;
+  const size_t num_active_modes = num_vectors_ * simd::kNumLanes;
+
+  // The modes past the last audible one are silent. Their lanes in the last
+  // vector are kept at rest with null coefficients, and they all restart from
+  // rest when they become audible again.
+  for (auto *c : {&mode_g_, &mode_r_plus_g_, &mode_h_, &mode_a_}) {
+    fill(c->begin() + num_modes, c->begin() + num_active_modes, 0.0f);
+  }
+  fill(state_1_.begin() + num_modes, state_1_.end(), 0.0f);
+  fill(state_2_.begin() + num_modes, state_2_.end(), 0.0f);
+}
+
+#if defined(__SSE2__) || defined(__AVX2__)
+
+template <size_t num_vectors>
+void Resonator::ProcessModes(const float *in, float *out, size_t size) {
+  using namespace simd;
+
+  Float g[num_vectors];
+  Float r_plus_g[num_vectors];
+  Float h[num_vectors];
+  Float gain[num_vectors];
+  Float state_1[num_vectors];
+  Float state_2[num_vectors];
+  for (size_t j = 0; j < num_vectors; ++j) {
+    g[j] = Load(&mode_g_[j * kNumLanes]);
+    r_plus_g[j] = Load(&mode_r_plus_g_[j * kNumLanes]);
+    h[j] = Load(&mode_h_[j * kNumLanes]);
+    gain[j] = Load(&mode_a_[j * kNumLanes]);
+    state_1[j] = Load(&state_1_[j * kNumLanes]);
+    state_2[j] = Load(&state_2_[j * kNumLanes]);
+  }
+
+  while (size--) {
+    const Float s_in = Set(*in++);
+    Float s_out = Set(0.0f);
+    for (size_t j = 0; j < num_vectors; ++j) {
+      const Float hp = Mul(
+          Sub(Sub(s_in, Mul(r_plus_g[j], state_1[j])), state_2[j]), h[j]);
+      const Float g_hp = Mul(g[j], hp);
+      const Float bp = Add(g_hp, state_1[j]);
+      state_1[j] = Add(g_hp, bp);
+      const Float g_bp = Mul(g[j], bp);
+      state_2[j] = Add(g_bp, Add(g_bp, state_2[j]));
+      s_out = Add(s_out, Mul(gain[j], bp));
+    }
+    *out++ += Sum(s_out);
+  }
+
+  for (size_t j = 0; j < num_vectors; ++j) {
+    Store(&state_1_[j * kNumLanes], state_1[j]);
+    Store(&state_2_[j * kNumLanes], state_2[j]);
+  }
+}
+
+#else
+
+void Resonator::ProcessModeBatches(const float *in, float *out,
+                                   size_t size) {
+  static_assert(simd::kNumLanes % kModeBatchSize == 0,
+                "The active modes must fill whole batches");
+  const size_t num_modes = num_vectors_ * simd::kNumLanes;
+  for (size_t b = 0; b < num_modes; b += kModeBatchSize) {
+    float g[kModeBatchSize];
+    float r_plus_g[kModeBatchSize];
+    float h[kModeBatchSize];
+    float gain[kModeBatchSize];
+    float state_1[kModeBatchSize];
+    float state_2[kModeBatchSize];
+    for (int i = 0; i < kModeBatchSize; ++i) {
+      g[i] = mode_g_[b + i];
+      r_plus_g[i] = mode_r_plus_g_[b + i];
+      h[i] = mode_h_[b + i];
+      gain[i] = mode_a_[b + i];
+      state_1[i] = state_1_[b + i];
+      state_2[i] = state_2_[b + i];
+    }
+
+    const float *batch_in = in;
+    float *batch_out = out;
+    for (size_t n = 0; n < size; ++n) {
+      const float s_in = *batch_in++;
+      float s_out = 0.0f;
+      for (int i = 0; i < kModeBatchSize; ++i) {
+        const float hp = (s_in - r_plus_g[i] * state_1[i] - state_2[i]) * h[i];
+        const float bp = g[i] * hp + state_1[i];
+        state_1[i] = g[i] * hp + bp;
+        const float lp = g[i] * bp + state_2[i];
+        state_2[i] = g[i] * bp + lp;
+        s_out += gain[i] * bp;
+      }
+      *batch_out++ += s_out;
+    }
+
+    for (int i = 0; i < kModeBatchSize; ++i) {
+      state_1_[b + i] = state_1[i];
+      state_2_[b + i] = state_2[i];
+    }
+  }
 }
 
+#endif // __SSE2__ || __AVX2__
+
 } // namespace plaits
@@ -29,7 +29,10 @@
 #ifndef PLAITS_DSP_PHYSICAL_MODELLING_RESONATOR_H_
 #define PLAITS_DSP_PHYSICAL_MODELLING_RESONATOR_H_
 
+#include "plaits/dsp/coefficient_cache.h"
+#include "plaits/dsp/simd.h"
 #include "stmlib/dsp/filter.h"
+#include <algorithm>
 #include <array>
 
 namespace plaits {
@@ -37,8 +40,17 @@ namespace plaits {
 const int kMaxNumModes = 24;
 const int kModeBatchSize = 4;
 
-// We render 4 modes simultaneously since there are enough registers to hold
-// all state variables.
+// Modes whose gain falls below this threshold (reached only close to Nyquist,
+// where the partials are attenuated) are not rendered.
+const float kModeGainThreshold = 1.0e-3f;
+
+static_assert(kMaxNumModes % simd::kNumLanes == 0,
+              "The modes must fill whole SIMD vectors");
+
+// A bank of batch_size SVFs sharing the same input. Still used for single
+// filters; the Resonator below keeps all its modes in SIMD vectors instead,
+// or renders them by batches of kModeBatchSize in the same way when there is
+// no vector unit.
 template <int batch_size> class ResonatorSvf {
 public:
   template <stmlib::FilterMode mode, bool add>
@@ -94,8 +106,32 @@ public:
   void Process(float f0, float structure, float brightness, float damping,
                const float *in, float *out, size_t size);
 
+  // Caps the number of partials, trading brightness for CPU time. Modes above
+  // the new count are silenced.
+  void set_max_num_modes(int max_num_modes) {
+    max_num_modes_ = std::clamp(max_num_modes, 1, kMaxNumModes);
+    coefficients_.Invalidate();
+  }
+  inline int max_num_modes() const { return max_num_modes_; }
+  // Modes rendered in the last block, rounded up to whole SIMD vectors.
+  inline int num_active_modes() const {
+    return num_vectors_ * simd::kNumLanes;
+  }
+  // Blocks which reused the mode coefficients of the previous one.
+  inline size_t num_cache_hits() const { return coefficients_.num_hits(); }
+
 private:
-  static constexpr auto resolution_{kMaxNumModes};
+  static constexpr size_t kMaxNumVectors = kMaxNumModes / simd::kNumLanes;
+
+  void ComputeModes(float f0, float structure, float brightness,
+                    float damping);
+
+#if defined(__SSE2__) || defined(__AVX2__)
+  template <size_t num_vectors>
+  void ProcessModes(const float *in, float *out, size_t size);
+#else
+  void ProcessModeBatches(const float *in, float *out, size_t size);
+#endif // __SSE2__ || __AVX2__
 
   static constexpr std::array<float, kMaxNumModes> mode_amplitude_{
       0.25,       0.24954998, 0.24820322, 0.24596936,  0.24286449, 0.238911,
@@ -103,8 +139,21 @@ private:
       0.19057527, 0.18131734, 0.17165393, 0.16165459,  0.15139134, 0.14093807,
       0.13037005, 0.11976336, 0.10919437, 0.098739184, 0.08847308, 0.078469984};
 
-  std::array<ResonatorSvf<kModeBatchSize>, kMaxNumModes / kModeBatchSize>
-      mode_filters_{};
+  // Band-pass SVF states, one SIMD lane per mode. All modes are advanced
+  // together, in a single pass over the block.
+  std::array<float, kMaxNumModes> state_1_{};
+  std::array<float, kMaxNumModes> state_2_{};
+
+  // Per-mode SVF coefficients, computed as ResonatorSvf would, and kept until
+  // the parameters move.
+  std::array<float, kMaxNumModes> mode_g_{};
+  std::array<float, kMaxNumModes> mode_r_plus_g_{};
+  std::array<float, kMaxNumModes> mode_h_{};
+  std::array<float, kMaxNumModes> mode_a_{};
+  size_t num_vectors_{};
+  CoefficientCache<4> coefficients_{};
+
+  int max_num_modes_{kMaxNumModes};
 };
 
 } // namespace plaits
@@ -79,27 +79,33 @@ void String::ProcessInternal(float f0, float non_linearity_amount,
     src_ratio = 1.0f;
   }
 
-  float damping_cutoff =
-      std::min(12.0f + damping * damping * 60.0f + brightness * 24.0f, 84.0f);
-  float damping_f =
-      std::min(f0 * stmlib::SemitonesToRatio(damping_cutoff), 0.499f);
-
   // Crossfade to infinite decay.
-  if (damping >= 0.95f) {
-    float to_infinite = 20.0f * (damping - 0.95f);
+  const bool infinite_decay = damping >= 0.95f;
+  const float to_infinite = 20.0f * (damping - 0.95f);
+
+  using Cache = CoefficientCache<3>;
+  if (damping_coefficients_.Miss({Cache::Frequency(f0),
+                                  Cache::Unit(brightness),
+                                  Cache::Unit(damping)})) {
+    float damping_cutoff = std::min(
+        12.0f + damping * damping * 60.0f + brightness * 24.0f, 84.0f);
+    float damping_f =
+        std::min(f0 * stmlib::SemitonesToRatio(damping_cutoff), 0.499f);
+    if (infinite_decay) {
+      damping_f += to_infinite * (0.4999f - damping_f);
+      damping_cutoff += to_infinite * (128.0f - damping_cutoff);
+    }
+    iir_damping_filter_.set_f_q<stmlib::FREQUENCY_FAST>(damping_f, 0.5f);
+    damping_compensation_ =
+        stmlib::Interpolate(lut_svf_shift, damping_cutoff, 1.0f);
+  }
+  if (infinite_decay) {
     brightness += to_infinite * (1.0f - brightness);
-    damping_f += to_infinite * (0.4999f - damping_f);
-    damping_cutoff += to_infinite * (128.0f - damping_cutoff);
   }
 
-  iir_damping_filter_.set_f_q<stmlib::FREQUENCY_FAST>(damping_f, 0.5f);
-
-  float damping_compensation =
-      stmlib::Interpolate(lut_svf_shift, damping_cutoff, 1.0f);
-
   // Linearly interpolate delay time.
   stmlib::ParameterInterpolator delay_modulation(
-      &delay_, delay * damping_compensation, size);
+      &delay_, delay * damping_compensation_, size);
 
   float stretch_point =
       non_linearity_amount * (2.0f - non_linearity_amount) * 0.225f;
@@ -29,6 +29,7 @@
 #ifndef PLAITS_DSP_PHYSICAL_MODELLING_STRING_H_
 #define PLAITS_DSP_PHYSICAL_MODELLING_STRING_H_
 
+#include "plaits/dsp/coefficient_cache.h"
 #include "plaits/dsp/dsp.h"
 #include "plaits/dsp/physical_modelling/delay_line.h"
 #include "stmlib/dsp/filter.h"
@@ -48,17 +49,27 @@ public:
   void Process(float f0, float non_linearity_amount, float brightness,
                float damping, const float *in, float *out, size_t size);
 
+  // Blocks which reused the damping filter coefficients of the previous one.
+  inline size_t num_cache_hits() const {
+    return damping_coefficients_.num_hits();
+  }
+
 private:
   template <StringNonLinearity non_linearity>
   void ProcessInternal(float f0, float non_linearity_amount, float brightness,
                        float damping, const float *in, float *out, size_t size);
 
-  DelayLine<float, kDelayLineSize> string_{};
+  MirroredDelayLine<float, kDelayLineSize> string_{};
   DelayLine<float, kDelayLineSize / 4> stretch_{};
 
   stmlib::Svf iir_damping_filter_{};
   stmlib::DCBlocker<1.0f - 20.0f / kSampleRate> dc_blocker_{};
 
+  // The damping filter's coefficients and the delay compensating for its
+  // phase shift are only recomputed when f0, brightness or damping move.
+  CoefficientCache<3> damping_coefficients_{};
+  float damping_compensation_{1.0f};
+
   float delay_{100.f};
   float dispersion_noise_{};
   float curved_bridge_{};
@@ -0,0 +1,693 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+//
+// -----------------------------------------------------------------------------
+//
+// A bank of Karplus-Strong strings, as String, rendered together in SIMD
+// lanes: for chords, strums and sympathetic resonance.
+//
+// The state of the strings is stored as structures of arrays. All the strings
+// advance their delay lines at the same rate, so they share a single write
+// pointer, and the delay lines of the strings of a SIMD vector are interleaved:
+// a write is a single vector store, and the taps read by each lane are
+// gathered. Each string has its own pitch and excitation (a burst of filtered
+// noise, as StringVoice produces on a trigger); brightness, damping and the
+// non-linearity are shared by the bank.
+//
+// Unlike String, the bank has no upsampler for the pitches whose period does
+// not fit in the delay line: they are clamped to the longest delay.
+//
+// Without SSE2 or AVX2, the emulated vectors do not stay in registers, and
+// the strings are rendered in scalar passes of two instead, from the same
+// interleaved state.
+
+#ifndef PLAITS_DSP_PHYSICAL_MODELLING_STRING_BANK_H_
+#define PLAITS_DSP_PHYSICAL_MODELLING_STRING_BANK_H_
+
+#include "stmlib/dsp/dsp.h"
+#include "stmlib/dsp/filter.h"
+#include "stmlib/dsp/units.h"
+#include "stmlib/utils/buffer_allocator.h"
+
+#include "plaits/dsp/coefficient_cache.h"
+#include "plaits/dsp/dsp.h"
+#include "plaits/dsp/engine/engine_buffer.h"
+#include "plaits/dsp/physical_modelling/string.h"
+#include "plaits/dsp/simd.h"
+#include "plaits/resources.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace plaits {
+
+template <size_t num_strings, size_t delay_line_size = kDelayLineSize>
+class StringBank {
+public:
+  // Padded to whole SIMD vectors; the extra strings are never excited.
+  static constexpr size_t kNumVectors =
+      (num_strings + simd::kNumLanes - 1) / simd::kNumLanes;
+  static constexpr size_t kSize = kNumVectors * simd::kNumLanes;
+  static constexpr size_t kStretchLineSize = delay_line_size / 4;
+
+  static_assert(std::has_single_bit(delay_line_size),
+                "The delay lines are indexed with a mask");
+
+private:
+  // For each SIMD vector, its main delay lines then its allpass delay lines,
+  // both interleaved by lane.
+  static constexpr size_t kVectorLinesSize =
+      (delay_line_size + kStretchLineSize) * simd::kNumLanes;
+  using Lines = EngineBuffer<float, kVectorLinesSize * kNumVectors>;
+
+public:
+  static constexpr size_t kSharedRamSize = Lines::kSharedRamSize;
+
+  void Init(stmlib::BufferAllocator *allocator, uint32_t seed = 0) {
+    lines_.Init(allocator);
+    for (size_t i = 0; i < kSize; ++i) {
+      f0_[i] = a0;
+      input_gain_[i] = i < num_strings ? 1.0f : 0.0f;
+      uint32_t x = (seed + uint32_t(i)) * 0x9e3779b9u;
+      x = (x ^ (x >> 16)) * 0x85ebca6bu;
+      x ^= x >> 13;
+      random_state_[i] = x ? x : 1;
+    }
+    Reset();
+  }
+
+  void Reset() {
+    lines_.fill(0.0f);
+    write_ptr_ = 0;
+    for (size_t i = 0; i < kSize; ++i) {
+      delay_[i] = 100.0f;
+      damping_state_[0][i] = damping_state_[1][i] = 0.0f;
+      excitation_state_[0][i] = excitation_state_[1][i] = 0.0f;
+      dc_blocker_x_[i] = dc_blocker_y_[i] = 0.0f;
+      dispersion_noise_[i] = curved_bridge_[i] = 0.0f;
+      burst_remaining_[i] = 0.0f;
+    }
+  }
+
+  void set_f0(size_t string, float f0) { f0_[string] = f0; }
+  inline float f0(size_t string) const { return f0_[string]; }
+
+  // How much of the input of Process() a string receives (1 by default).
+  void set_input_gain(size_t string, float gain) { input_gain_[string] = gain; }
+
+  // Excites a string with a burst of noise lasting one period.
+  void Pluck(size_t string, float amplitude) {
+    burst_amplitude_[string] = amplitude;
+    burst_remaining_[string] = static_cast<float>(
+        static_cast<size_t>(1.0f / f0_[string]));
+  }
+
+  // Adds the sum of the strings to out. in is fed to all the strings, scaled
+  // by their input gain.
+  void Process(float non_linearity_amount, float brightness, float damping,
+               const float *in, float *out, size_t size) {
+    if (non_linearity_amount <= 0.0f) {
+      ProcessInternal<STRING_NON_LINEARITY_CURVED_BRIDGE>(
+          -non_linearity_amount, brightness, damping, in, out, size);
+    } else {
+      ProcessInternal<STRING_NON_LINEARITY_DISPERSION>(
+          non_linearity_amount, brightness, damping, in, out, size);
+    }
+  }
+
+  // Blocks and strings which reused the coefficients of the previous block.
+  inline size_t num_cache_hits() const {
+    size_t hits = 0;
+    for (size_t i = 0; i < num_strings; ++i) {
+      hits += coefficients_[i].num_hits();
+    }
+    return hits;
+  }
+
+private:
+  static constexpr size_t kMask = delay_line_size - 1;
+  static constexpr size_t kStretchMask = kStretchLineSize - 1;
+  static constexpr int kLaneShift = std::countr_zero(simd::kNumLanes);
+  static constexpr auto kLaneIndex = [] {
+    std::array<uint32_t, simd::kNumLanes> index{};
+    for (size_t i = 0; i < index.size(); ++i) {
+      index[i] = uint32_t(i);
+    }
+    return index;
+  }();
+
+  // The damping and excitation filters, as the SVFs of String and
+  // StringVoice, only depend on the pitch, brightness and damping.
+  void UpdateCoefficients(size_t i, float brightness, float damping) {
+    using Cache = CoefficientCache<3>;
+    const float f0 = f0_[i];
+    if (!coefficients_[i].Miss({Cache::Frequency(f0), Cache::Unit(brightness),
+                                Cache::Unit(damping)})) {
+      return;
+    }
+    float damping_cutoff = std::min(
+        12.0f + damping * damping * 60.0f + brightness * 24.0f, 84.0f);
+    float damping_f =
+        std::min(f0 * stmlib::SemitonesToRatio(damping_cutoff), 0.499f);
+    if (damping >= 0.95f) {
+      const float to_infinite = 20.0f * (damping - 0.95f);
+      damping_f += to_infinite * (0.4999f - damping_f);
+      damping_cutoff += to_infinite * (128.0f - damping_cutoff);
+    }
+    SetLowPass(stmlib::OnePole::tan<stmlib::FREQUENCY_FAST>(damping_f),
+               &damping_coefficients_[0][i]);
+    damping_compensation_[i] =
+        stmlib::Interpolate(lut_svf_shift, damping_cutoff, 1.0f);
+
+    const float excitation_f = std::min(
+        4.0f * f0 * stmlib::SemitonesToRatio(
+            (brightness * (2.0f - brightness) - 0.5f) * 72.0f),
+        0.499f);
+    SetLowPass(stmlib::OnePole::tan<stmlib::FREQUENCY_DIRTY>(excitation_f),
+               &excitation_coefficients_[0][i]);
+  }
+
+  // g, r + g and h of a SVF with a Q of 0.5, in lane i of coefficients.
+  static void SetLowPass(float g, float *coefficients) {
+    const float r = 2.0f;
+    coefficients[0] = g;
+    coefficients[kSize] = r + g;
+    coefficients[2 * kSize] = 1.0f / (1.0f + r * g + g * g);
+  }
+
+  static inline simd::Float LowPass(simd::Float in, const simd::Float *c,
+                                    simd::Float *state_1,
+                                    simd::Float *state_2) {
+    using namespace simd;
+    const Float hp = Mul(Sub(Sub(in, Mul(c[1], *state_1)), *state_2), c[2]);
+    const Float g_hp = Mul(c[0], hp);
+    const Float bp = Add(g_hp, *state_1);
+    *state_1 = Add(g_hp, bp);
+    const Float g_bp = Mul(c[0], bp);
+    const Float lp = Add(g_bp, *state_2);
+    *state_2 = Add(g_bp, lp);
+    return lp;
+  }
+
+  static inline simd::Float Abs(simd::Float x) {
+    using namespace simd;
+    return AsFloat(And(AsInt(x), Set(uint32_t{0x7fffffff})));
+  }
+
+  // Tap at position (t + offset) & mask of the lines of a vector.
+  template <size_t mask>
+  static inline simd::Float Tap(const float *line, simd::Int t,
+                                uint32_t offset) {
+    using namespace simd;
+    const Int position = And(Add(t, Set(offset)), Set(uint32_t{mask}));
+    return Lookup(line, Add(ShiftLeft<kLaneShift>(position),
+                            Load(kLaneIndex.data())));
+  }
+
+  // As DelayLine::Read() and DelayLine::ReadHermite().
+  static inline simd::Float Read(const float *line, simd::Int write_ptr,
+                                 simd::Float delay) {
+    using namespace simd;
+    const Int integral = Truncate(delay);
+    const Float fractional = Sub(delay, ToFloat(integral));
+    const Int t = Add(write_ptr, integral);
+    const Float a = Tap<kMask>(line, t, 0);
+    const Float b = Tap<kMask>(line, t, 1);
+    return Add(a, Mul(Sub(b, a), fractional));
+  }
+
+  static inline simd::Float ReadHermite(const float *line, simd::Int write_ptr,
+                                        simd::Float delay) {
+    using namespace simd;
+    const Int integral = Truncate(delay);
+    const Float f = Sub(delay, ToFloat(integral));
+    const Int t = Add(write_ptr, integral);
+    const Float xm1 = Tap<kMask>(line, t, ~uint32_t{0});
+    const Float x0 = Tap<kMask>(line, t, 0);
+    const Float x1 = Tap<kMask>(line, t, 1);
+    const Float x2 = Tap<kMask>(line, t, 2);
+    const Float half = Set(0.5f);
+    const Float c = Mul(Sub(x1, xm1), half);
+    const Float v = Sub(x0, x1);
+    const Float w = Add(c, v);
+    const Float a = Add(Add(w, v), Mul(Sub(x2, x0), half));
+    const Float b_neg = Add(w, a);
+    return Add(Mul(Add(Mul(Sub(Mul(a, f), b_neg), f), c), f), x0);
+  }
+
+  // Parameters shared by all the strings for a block.
+  struct Shared {
+    float noise_amount;
+    float noise_filter;
+    float bridge_curving;
+    float ap_gain;
+    float stretch;
+  };
+
+  template <StringNonLinearity non_linearity>
+  void ProcessInternal(float non_linearity_amount, float brightness,
+                       float damping, const float *in, float *out,
+                       size_t size) {
+    const float stretch_point =
+        non_linearity_amount * (2.0f - non_linearity_amount) * 0.225f;
+    const float inv_size = 1.0f / float(size);
+    for (size_t i = 0; i < num_strings; ++i) {
+      UpdateCoefficients(i, brightness, damping);
+      float delay = 1.0f / f0_[i];
+      CONSTRAIN(delay, 4.0f, float(delay_line_size) - 4.0f);
+      delay_increment_[i] =
+          (delay * damping_compensation_[i] - delay_[i]) * inv_size;
+      float stretch_correction = (160.0f / kSampleRate) * delay;
+      CONSTRAIN(stretch_correction, 1.0f, 2.1f);
+      main_delay_factor_[i] =
+          (0.408f - stretch_point * 0.308f) * stretch_correction;
+    }
+
+    // Crossfade to infinite decay.
+    if (damping >= 0.95f) {
+      const float to_infinite = 20.0f * (damping - 0.95f);
+      brightness += to_infinite * (1.0f - brightness);
+    }
+
+    const float noise_amount_sqrt = non_linearity_amount > 0.75f
+                                        ? 4.0f * (non_linearity_amount - 0.75f)
+                                        : 0.0f;
+    Shared shared;
+    shared.noise_amount = noise_amount_sqrt * noise_amount_sqrt * 0.1f;
+    shared.noise_filter = 0.06f + 0.94f * brightness * brightness;
+    shared.bridge_curving = non_linearity_amount * non_linearity_amount * 0.01f;
+    shared.ap_gain = -0.618f * non_linearity_amount /
+                     (0.15f + fabsf(non_linearity_amount));
+    shared.stretch = stretch_point;
+
+#if defined(__SSE2__) || defined(__AVX2__)
+    ProcessVectors<non_linearity>(shared, in, out, size);
+#else
+    size_t i = 0;
+    for (; i + 2 <= num_strings; i += 2) {
+      ProcessBatch<non_linearity, 2>(i, shared, in, out, size);
+    }
+    if (i < num_strings) {
+      ProcessBatch<non_linearity, 1>(i, shared, in, out, size);
+    }
+    write_ptr_ = (write_ptr_ - size) & kMask;
+#endif // __SSE2__ || __AVX2__
+  }
+
+#if defined(__SSE2__) || defined(__AVX2__)
+
+  template <StringNonLinearity non_linearity>
+  void ProcessVectors(const Shared &shared, const float *in, float *out,
+                      size_t size) {
+    using namespace simd;
+
+    const Float noise_amount = Set(shared.noise_amount);
+    const Float noise_filter = Set(shared.noise_filter);
+    const Float bridge_curving = Set(shared.bridge_curving);
+    const Float ap_gain = Set(shared.ap_gain);
+    const Float stretch = Set(shared.stretch);
+    const Float zero = Set(0.0f);
+    const Float half = Set(0.5f);
+    const Float one = Set(1.0f);
+    const Float four = Set(4.0f);
+    const Float dc_blocker_pole = Set(1.0f - 20.0f / kSampleRate);
+
+    Float damping_coefficients[kNumVectors][3];
+    Float excitation_coefficients[kNumVectors][3];
+    Float delay[kNumVectors];
+    Float delay_increment[kNumVectors];
+    Float main_delay_factor[kNumVectors];
+    Float input_gain[kNumVectors];
+    Float burst_amplitude[kNumVectors];
+    Float burst_remaining[kNumVectors];
+    Float excitation_state[kNumVectors][2];
+    Float damping_state[kNumVectors][2];
+    Float dc_blocker_x[kNumVectors];
+    Float dc_blocker_y[kNumVectors];
+    Float dispersion_noise[kNumVectors];
+    Float curved_bridge[kNumVectors];
+    Int random_state[kNumVectors];
+
+    for (size_t j = 0; j < kNumVectors; ++j) {
+      const size_t i = j * kNumLanes;
+      for (size_t k = 0; k < 3; ++k) {
+        damping_coefficients[j][k] = Load(&damping_coefficients_[k][i]);
+        excitation_coefficients[j][k] = Load(&excitation_coefficients_[k][i]);
+      }
+      delay[j] = Load(&delay_[i]);
+      delay_increment[j] = Load(&delay_increment_[i]);
+      main_delay_factor[j] = Load(&main_delay_factor_[i]);
+      input_gain[j] = Load(&input_gain_[i]);
+      burst_amplitude[j] = Load(&burst_amplitude_[i]);
+      burst_remaining[j] = Load(&burst_remaining_[i]);
+      for (size_t k = 0; k < 2; ++k) {
+        excitation_state[j][k] = Load(&excitation_state_[k][i]);
+        damping_state[j][k] = Load(&damping_state_[k][i]);
+      }
+      dc_blocker_x[j] = Load(&dc_blocker_x_[i]);
+      dc_blocker_y[j] = Load(&dc_blocker_y_[i]);
+      dispersion_noise[j] = Load(&dispersion_noise_[i]);
+      curved_bridge[j] = Load(&curved_bridge_[i]);
+      random_state[j] = Load(&random_state_[i]);
+    }
+
+    while (size--) {
+      const Float input = Set(*in++);
+      const Int write_ptr = Set(uint32_t(write_ptr_));
+      Float sum = zero;
+      for (size_t j = 0; j < kNumVectors; ++j) {
+        float *line = lines_.data() + j * kVectorLinesSize;
+        float *stretch_line = line + delay_line_size * kNumLanes;
+
+        // One random number per string and per sample, for the excitation
+        // burst and the dispersion noise.
+        Int x = random_state[j];
+        x = Xor(x, ShiftLeft<13>(x));
+        x = Xor(x, ShiftRight<17>(x));
+        x = Xor(x, ShiftLeft<5>(x));
+        random_state[j] = x;
+        const Float random =
+            Mul(ToFloat(ShiftRight<8>(x)), Set(1.0f / 16777216.0f));
+
+        const Int bursting = LessThan(zero, burst_remaining[j]);
+        burst_remaining[j] = Max(Sub(burst_remaining[j], one), zero);
+        const Float burst = Select(
+            bursting, Mul(Sub(Add(random, random), one), burst_amplitude[j]),
+            zero);
+        const Float excitation =
+            LowPass(burst, excitation_coefficients[j], &excitation_state[j][0],
+                    &excitation_state[j][1]);
+
+        delay[j] = Add(delay[j], delay_increment[j]);
+        Float d = delay[j];
+        Float s;
+        if constexpr (non_linearity == STRING_NON_LINEARITY_DISPERSION) {
+          const Float noise = Sub(random, half);
+          dispersion_noise[j] = Add(
+              dispersion_noise[j],
+              Mul(noise_filter, Sub(noise, dispersion_noise[j])));
+          d = Mul(d, Add(one, Mul(dispersion_noise[j], noise_amount)));
+
+          // The allpass line is written even when its output is not used.
+          const Float ap_delay = Mul(d, stretch);
+          const Float main_delay =
+              Sub(d, Mul(ap_delay, main_delay_factor[j]));
+          const Int ap_t = Add(Set(uint32_t(write_ptr_ & kStretchMask)),
+                               Truncate(ap_delay));
+          const Float ap_read = Tap<kStretchMask>(stretch_line, ap_t, 0);
+          const Float ap_write =
+              Add(Read(line, write_ptr, main_delay), Mul(ap_gain, ap_read));
+          Store(&stretch_line[(write_ptr_ & kStretchMask) * kNumLanes],
+                ap_write);
+          const Float dispersed = Sub(ap_read, Mul(ap_write, ap_gain));
+          const Float plain = ReadHermite(line, write_ptr, d);
+          s = Select(LessThan(ap_delay, four), plain,
+                     Select(LessThan(main_delay, four), plain, dispersed));
+        } else {
+          d = Mul(d, Sub(one, Mul(curved_bridge[j], bridge_curving)));
+          s = ReadHermite(line, write_ptr, d);
+          const Float value = Sub(Abs(s), Set(0.025f));
+          const Float sign = Select(LessThan(zero, s), one, Set(-1.5f));
+          curved_bridge[j] = Mul(Add(Abs(value), value), sign);
+        }
+
+        s = Add(s, Add(Mul(input, input_gain[j]), excitation));
+        s = Min(Max(s, Set(-20.0f)), Set(20.0f));
+
+        dc_blocker_y[j] =
+            Add(Mul(dc_blocker_y[j], dc_blocker_pole), Sub(s, dc_blocker_x[j]));
+        dc_blocker_x[j] = s;
+        s = LowPass(dc_blocker_y[j], damping_coefficients[j],
+                    &damping_state[j][0], &damping_state[j][1]);
+        Store(&line[write_ptr_ * kNumLanes], s);
+        sum = Add(sum, s);
+      }
+      *out++ += Sum(sum);
+      write_ptr_ = (write_ptr_ - 1) & kMask;
+    }
+
+    for (size_t j = 0; j < kNumVectors; ++j) {
+      const size_t i = j * kNumLanes;
+      Store(&delay_[i], delay[j]);
+      Store(&burst_remaining_[i], burst_remaining[j]);
+      for (size_t k = 0; k < 2; ++k) {
+        Store(&excitation_state_[k][i], excitation_state[j][k]);
+        Store(&damping_state_[k][i], damping_state[j][k]);
+      }
+      Store(&dc_blocker_x_[i], dc_blocker_x[j]);
+      Store(&dc_blocker_y_[i], dc_blocker_y[j]);
+      Store(&dispersion_noise_[i], dispersion_noise[j]);
+      Store(&curved_bridge_[i], curved_bridge[j]);
+      Store(&random_state_[i], random_state[j]);
+    }
+  }
+
+#else
+
+  // As the vector loop, on the lanes of a batch of strings. Two strings per
+  // pass interleave two independent feedback paths.
+  template <StringNonLinearity non_linearity, bool excited, size_t n>
+  void ProcessStrings(size_t first, const Shared &shared, const float *in,
+                      float *out, size_t size) {
+    const float dc_blocker_pole = 1.0f - 20.0f / kSampleRate;
+
+    float *line[n];
+    float *stretch_line[n];
+    float g_e[n], r_plus_g_e[n], h_e[n];
+    float g_d[n], r_plus_g_d[n], h_d[n];
+    float delay_increment[n], main_delay_factor[n];
+    float input_gain[n], burst_amplitude[n];
+    float delay[n], burst_remaining[n];
+    float excitation_1[n], excitation_2[n], damping_1[n], damping_2[n];
+    float dc_blocker_x[n], dc_blocker_y[n];
+    float dispersion_noise[n], curved_bridge[n];
+    uint32_t x[n];
+
+    for (size_t k = 0; k < n; ++k) {
+      const size_t i = first + k;
+      line[k] = lines_.data() + (i >> kLaneShift) * kVectorLinesSize +
+                (i & (simd::kNumLanes - 1));
+      stretch_line[k] = line[k] + delay_line_size * simd::kNumLanes;
+      g_e[k] = excitation_coefficients_[0][i];
+      r_plus_g_e[k] = excitation_coefficients_[1][i];
+      h_e[k] = excitation_coefficients_[2][i];
+      g_d[k] = damping_coefficients_[0][i];
+      r_plus_g_d[k] = damping_coefficients_[1][i];
+      h_d[k] = damping_coefficients_[2][i];
+      delay_increment[k] = delay_increment_[i];
+      main_delay_factor[k] = main_delay_factor_[i];
+      input_gain[k] = input_gain_[i];
+      burst_amplitude[k] = burst_amplitude_[i];
+      delay[k] = delay_[i];
+      burst_remaining[k] = burst_remaining_[i];
+      excitation_1[k] = excitation_state_[0][i];
+      excitation_2[k] = excitation_state_[1][i];
+      damping_1[k] = damping_state_[0][i];
+      damping_2[k] = damping_state_[1][i];
+      dc_blocker_x[k] = dc_blocker_x_[i];
+      dc_blocker_y[k] = dc_blocker_y_[i];
+      dispersion_noise[k] = dispersion_noise_[i];
+      curved_bridge[k] = curved_bridge_[i];
+      x[k] = random_state_[i];
+    }
+
+    uint32_t write_ptr = uint32_t(write_ptr_);
+    for (size_t j = 0; j < size; ++j) {
+      float sum = 0.0f;
+      for (size_t k = 0; k < n; ++k) {
+        float random = 0.0f;
+        if constexpr (excited ||
+                      non_linearity == STRING_NON_LINEARITY_DISPERSION) {
+          x[k] ^= x[k] << 13;
+          x[k] ^= x[k] >> 17;
+          x[k] ^= x[k] << 5;
+          random = float(x[k] >> 8) * (1.0f / 16777216.0f);
+        }
+
+        float excitation = 0.0f;
+        if constexpr (excited) {
+          const float burst = burst_remaining[k] > 0.0f
+              ? (random + random - 1.0f) * burst_amplitude[k]
+              : 0.0f;
+          burst_remaining[k] = std::max(burst_remaining[k] - 1.0f, 0.0f);
+          excitation = LowPass(burst, g_e[k], r_plus_g_e[k], h_e[k],
+                               &excitation_1[k], &excitation_2[k]);
+        }
+
+        delay[k] += delay_increment[k];
+        float d = delay[k];
+        float s;
+        if constexpr (non_linearity == STRING_NON_LINEARITY_DISPERSION) {
+          dispersion_noise[k] +=
+              shared.noise_filter * (random - 0.5f - dispersion_noise[k]);
+          d *= 1.0f + dispersion_noise[k] * shared.noise_amount;
+
+          // Unlike the vector loop, and as String does, the allpass line is
+          // only written when its output is used.
+          const float ap_delay = d * shared.stretch;
+          const float main_delay = d - ap_delay * main_delay_factor[k];
+          if (ap_delay >= 4.0f && main_delay >= 4.0f) {
+            const uint32_t ap_t = (write_ptr & kStretchMask) +
+                                  static_cast<uint32_t>(int32_t(ap_delay));
+            const float ap_read =
+                stretch_line[k][size_t(ap_t & kStretchMask) << kLaneShift];
+            const float ap_write = Read(line[k], write_ptr, main_delay) +
+                                   shared.ap_gain * ap_read;
+            stretch_line[k][size_t(write_ptr & kStretchMask) << kLaneShift] =
+                ap_write;
+            s = ap_read - ap_write * shared.ap_gain;
+          } else {
+            s = ReadHermite(line[k], write_ptr, d);
+          }
+        } else {
+          d *= 1.0f - curved_bridge[k] * shared.bridge_curving;
+          s = ReadHermite(line[k], write_ptr, d);
+          const float value = fabsf(s) - 0.025f;
+          const float sign = s > 0.0f ? 1.0f : -1.5f;
+          curved_bridge[k] = (fabsf(value) + value) * sign;
+        }
+
+        s += in[j] * input_gain[k] + excitation;
+        s = std::min(std::max(s, -20.0f), 20.0f);
+
+        dc_blocker_y[k] =
+            dc_blocker_y[k] * dc_blocker_pole + (s - dc_blocker_x[k]);
+        dc_blocker_x[k] = s;
+        s = LowPass(dc_blocker_y[k], g_d[k], r_plus_g_d[k], h_d[k],
+                    &damping_1[k], &damping_2[k]);
+        line[k][size_t(write_ptr) << kLaneShift] = s;
+        sum += s;
+      }
+      out[j] += sum;
+      write_ptr = (write_ptr - 1) & kMask;
+    }
+
+    for (size_t k = 0; k < n; ++k) {
+      const size_t i = first + k;
+      delay_[i] = delay[k];
+      burst_remaining_[i] = burst_remaining[k];
+      excitation_state_[0][i] = excitation_1[k];
+      excitation_state_[1][i] = excitation_2[k];
+      damping_state_[0][i] = damping_1[k];
+      damping_state_[1][i] = damping_2[k];
+      dc_blocker_x_[i] = dc_blocker_x[k];
+      dc_blocker_y_[i] = dc_blocker_y[k];
+      dispersion_noise_[i] = dispersion_noise[k];
+      curved_bridge_[i] = curved_bridge[k];
+      random_state_[i] = x[k];
+    }
+  }
+
+  template <StringNonLinearity non_linearity, size_t n>
+  void ProcessBatch(size_t first, const Shared &shared, const float *in,
+                    float *out, size_t size) {
+    // Once their bursts have died out, the strings no longer need their
+    // excitation filter - nor, on a curved bridge, their noise.
+    bool excited = false;
+    for (size_t i = first; i < first + n; ++i) {
+      excited = excited || burst_remaining_[i] > 0.0f ||
+                fabsf(excitation_state_[0][i]) +
+                        fabsf(excitation_state_[1][i]) >
+                    1.0e-9f;
+    }
+    if (excited) {
+      ProcessStrings<non_linearity, true, n>(first, shared, in, out, size);
+    } else {
+      for (size_t i = first; i < first + n; ++i) {
+        excitation_state_[0][i] = excitation_state_[1][i] = 0.0f;
+      }
+      ProcessStrings<non_linearity, false, n>(first, shared, in, out, size);
+    }
+  }
+
+  // The SVF low-pass of the vector loop, on one lane.
+  static inline float LowPass(float in, float g, float r_plus_g, float h,
+                              float *state_1, float *state_2) {
+    const float hp = (in - r_plus_g * *state_1 - *state_2) * h;
+    const float g_bp = g * hp;
+    const float bp = g_bp + *state_1;
+    *state_1 = g_bp + bp;
+    const float g_lp = g * bp;
+    const float lp = g_lp + *state_2;
+    *state_2 = g_lp + lp;
+    return lp;
+  }
+
+  // As DelayLine::Read() and DelayLine::ReadHermite(), on one lane.
+  static inline float Read(const float *line, uint32_t write_ptr,
+                           float delay) {
+    const int32_t integral = int32_t(delay);
+    const float fractional = delay - float(integral);
+    const uint32_t t = write_ptr + uint32_t(integral);
+    const float a = line[size_t(t & kMask) << kLaneShift];
+    const float b = line[size_t((t + 1) & kMask) << kLaneShift];
+    return a + (b - a) * fractional;
+  }
+
+  static inline float ReadHermite(const float *line, uint32_t write_ptr,
+                                  float delay) {
+    const int32_t integral = int32_t(delay);
+    const float f = delay - float(integral);
+    const uint32_t t = write_ptr + uint32_t(integral);
+    const float xm1 = line[size_t((t - 1) & kMask) << kLaneShift];
+    const float x0 = line[size_t(t & kMask) << kLaneShift];
+    const float x1 = line[size_t((t + 1) & kMask) << kLaneShift];
+    const float x2 = line[size_t((t + 2) & kMask) << kLaneShift];
+    const float c = (x1 - xm1) * 0.5f;
+    const float v = x0 - x1;
+    const float w = c + v;
+    const float a = w + v + (x2 - x0) * 0.5f;
+    const float b_neg = w + a;
+    return (((a * f) - b_neg) * f + c) * f + x0;
+  }
+
+#endif // __SSE2__ || __AVX2__
+
+  Lines lines_{};
+  size_t write_ptr_{};
+
+  std::array<float, kSize> f0_{};
+  std::array<float, kSize> input_gain_{};
+  std::array<CoefficientCache<3>, num_strings> coefficients_{};
+  // g, r + g and h of the damping and excitation filters.
+  std::array<std::array<float, kSize>, 3> damping_coefficients_{};
+  std::array<std::array<float, kSize>, 3> excitation_coefficients_{};
+  std::array<float, kSize> damping_compensation_{};
+  std::array<float, kSize> main_delay_factor_{};
+
+  std::array<float, kSize> delay_{};
+  std::array<float, kSize> delay_increment_{};
+  std::array<float, kSize> burst_amplitude_{};
+  std::array<float, kSize> burst_remaining_{};
+  std::array<std::array<float, kSize>, 2> excitation_state_{};
+  std::array<std::array<float, kSize>, 2> damping_state_{};
+  std::array<float, kSize> dc_blocker_x_{};
+  std::array<float, kSize> dc_blocker_y_{};
+  std::array<float, kSize> dispersion_noise_{};
+  std::array<float, kSize> curved_bridge_{};
+  std::array<uint32_t, kSize> random_state_{};
+};
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_PHYSICAL_MODELLING_STRING_BANK_H_
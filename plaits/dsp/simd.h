@@ -0,0 +1,329 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Minimal vector types for rendering several voices or modes in parallel.
+//
+// The width is chosen at build time: 8 lanes with AVX2, 4 lanes with SSE2,
+// and 4 lanes emulated with plain arrays elsewhere (which the compiler may
+// still map on NEON). Code written against these types stays the same for all
+// targets; only kNumLanes changes.
+
+#ifndef PLAITS_DSP_SIMD_H_
+#define PLAITS_DSP_SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif // __AVX2__
+
+namespace plaits {
+
+namespace simd {
+
+#if defined(__AVX2__)
+
+inline constexpr size_t kNumLanes = 8;
+
+using Float = __m256;
+using Int = __m256i;
+
+inline Float Load(const float *p) { return _mm256_loadu_ps(p); }
+inline Int Load(const uint32_t *p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+inline void Store(float *p, Float x) { _mm256_storeu_ps(p, x); }
+inline void Store(uint32_t *p, Int x) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), x);
+}
+inline Float Set(float x) { return _mm256_set1_ps(x); }
+inline Int Set(uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+
+inline Float Add(Float a, Float b) { return _mm256_add_ps(a, b); }
+inline Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+inline Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+inline Float Min(Float a, Float b) { return _mm256_min_ps(a, b); }
+inline Float Max(Float a, Float b) { return _mm256_max_ps(a, b); }
+inline Int Add(Int a, Int b) { return _mm256_add_epi32(a, b); }
+inline Int And(Int a, Int b) { return _mm256_and_si256(a, b); }
+inline Int Xor(Int a, Int b) { return _mm256_xor_si256(a, b); }
+
+// All bits set in the lanes where a < b.
+inline Int LessThan(Float a, Float b) {
+  return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LT_OQ));
+}
+inline Int Equal(Int a, Int b) { return _mm256_cmpeq_epi32(a, b); }
+
+// Lanes of a where the mask is set, of b elsewhere. The mask lanes must be
+// all ones or all zeros, as returned by the comparisons.
+inline Float Select(Int mask, Float a, Float b) {
+  return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask));
+}
+inline Int Select(Int mask, Int a, Int b) {
+  return _mm256_blendv_epi8(b, a, mask);
+}
+
+// Reinterpret the bits, as the union in Pow2Fast() does.
+inline Int AsInt(Float x) { return _mm256_castps_si256(x); }
+inline Float AsFloat(Int x) { return _mm256_castsi256_ps(x); }
+
+template <int bits> inline Int ShiftLeft(Int x) {
+  return _mm256_slli_epi32(x, bits);
+}
+template <int bits> inline Int ShiftRight(Int x) {
+  return _mm256_srli_epi32(x, bits);
+}
+
+// Truncates to int32; the lanes must be within [-2^31, 2^31).
+inline Int Truncate(Float x) { return _mm256_cvttps_epi32(x); }
+// Lanes are read as int32.
+inline Float ToFloat(Int x) { return _mm256_cvtepi32_ps(x); }
+
+inline Float Lookup(const float *table, Int index) {
+  return _mm256_i32gather_ps(table, index, 4);
+}
+
+// Sum of all lanes.
+inline float Sum(Float x) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+  return _mm_cvtss_f32(s);
+}
+
+#elif defined(__SSE2__)
+
+inline constexpr size_t kNumLanes = 4;
+
+using Float = __m128;
+using Int = __m128i;
+
+inline Float Load(const float *p) { return _mm_loadu_ps(p); }
+inline Int Load(const uint32_t *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline void Store(float *p, Float x) { _mm_storeu_ps(p, x); }
+inline void Store(uint32_t *p, Int x) {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x);
+}
+inline Float Set(float x) { return _mm_set1_ps(x); }
+inline Int Set(uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+
+inline Float Add(Float a, Float b) { return _mm_add_ps(a, b); }
+inline Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+inline Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+inline Float Min(Float a, Float b) { return _mm_min_ps(a, b); }
+inline Float Max(Float a, Float b) { return _mm_max_ps(a, b); }
+inline Int Add(Int a, Int b) { return _mm_add_epi32(a, b); }
+inline Int And(Int a, Int b) { return _mm_and_si128(a, b); }
+inline Int Xor(Int a, Int b) { return _mm_xor_si128(a, b); }
+
+inline Int LessThan(Float a, Float b) {
+  return _mm_castps_si128(_mm_cmplt_ps(a, b));
+}
+inline Int Equal(Int a, Int b) { return _mm_cmpeq_epi32(a, b); }
+
+// No blend before SSE4.1.
+inline Int Select(Int mask, Int a, Int b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+inline Float Select(Int mask, Float a, Float b) {
+  return _mm_castsi128_ps(
+      Select(mask, _mm_castps_si128(a), _mm_castps_si128(b)));
+}
+
+inline Int AsInt(Float x) { return _mm_castps_si128(x); }
+inline Float AsFloat(Int x) { return _mm_castsi128_ps(x); }
+
+template <int bits> inline Int ShiftLeft(Int x) {
+  return _mm_slli_epi32(x, bits);
+}
+template <int bits> inline Int ShiftRight(Int x) {
+  return _mm_srli_epi32(x, bits);
+}
+
+inline Int Truncate(Float x) { return _mm_cvttps_epi32(x); }
+inline Float ToFloat(Int x) { return _mm_cvtepi32_ps(x); }
+
+// No gather before AVX2.
+inline Float Lookup(const float *table, Int index) {
+  alignas(16) uint32_t i[4];
+  _mm_store_si128(reinterpret_cast<__m128i *>(i), index);
+  return _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+}
+
+inline float Sum(Float x) {
+  __m128 s = _mm_add_ps(x, _mm_movehl_ps(x, x));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+  return _mm_cvtss_f32(s);
+}
+
+#else
+
+inline constexpr size_t kNumLanes = 4;
+
+struct Float {
+  float v[kNumLanes];
+};
+
+struct Int {
+  uint32_t v[kNumLanes];
+};
+
+template <typename T, typename F> inline T Map(F fn) {
+  T result;
+  for (size_t i = 0; i < kNumLanes; ++i) {
+    result.v[i] = fn(i);
+  }
+  return result;
+}
+
+inline Float Load(const float *p) {
+  return Map<Float>([p](size_t i) { return p[i]; });
+}
+inline Int Load(const uint32_t *p) {
+  return Map<Int>([p](size_t i) { return p[i]; });
+}
+inline void Store(float *p, Float x) {
+  for (size_t i = 0; i < kNumLanes; ++i) {
+    p[i] = x.v[i];
+  }
+}
+inline void Store(uint32_t *p, Int x) {
+  for (size_t i = 0; i < kNumLanes; ++i) {
+    p[i] = x.v[i];
+  }
+}
+inline Float Set(float x) {
+  return Map<Float>([x](size_t) { return x; });
+}
+inline Int Set(uint32_t x) {
+  return Map<Int>([x](size_t) { return x; });
+}
+
+inline Float Add(Float a, Float b) {
+  return Map<Float>([&](size_t i) { return a.v[i] + b.v[i]; });
+}
+inline Float Sub(Float a, Float b) {
+  return Map<Float>([&](size_t i) { return a.v[i] - b.v[i]; });
+}
+inline Float Mul(Float a, Float b) {
+  return Map<Float>([&](size_t i) { return a.v[i] * b.v[i]; });
+}
+inline Float Min(Float a, Float b) {
+  return Map<Float>([&](size_t i) {
+    return a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+  });
+}
+inline Float Max(Float a, Float b) {
+  return Map<Float>([&](size_t i) {
+    return a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+  });
+}
+inline Int Add(Int a, Int b) {
+  return Map<Int>([&](size_t i) { return a.v[i] + b.v[i]; });
+}
+inline Int And(Int a, Int b) {
+  return Map<Int>([&](size_t i) { return a.v[i] & b.v[i]; });
+}
+inline Int Xor(Int a, Int b) {
+  return Map<Int>([&](size_t i) { return a.v[i] ^ b.v[i]; });
+}
+
+inline Int LessThan(Float a, Float b) {
+  return Map<Int>([&](size_t i) { return a.v[i] < b.v[i] ? ~0u : 0u; });
+}
+inline Int Equal(Int a, Int b) {
+  return Map<Int>([&](size_t i) { return a.v[i] == b.v[i] ? ~0u : 0u; });
+}
+
+inline Float Select(Int mask, Float a, Float b) {
+  return Map<Float>([&](size_t i) { return mask.v[i] ? a.v[i] : b.v[i]; });
+}
+inline Int Select(Int mask, Int a, Int b) {
+  return Map<Int>([&](size_t i) { return mask.v[i] ? a.v[i] : b.v[i]; });
+}
+
+inline Int AsInt(Float x) {
+  return Map<Int>([&](size_t i) {
+    uint32_t bits;
+    std::memcpy(&bits, &x.v[i], sizeof(bits));
+    return bits;
+  });
+}
+inline Float AsFloat(Int x) {
+  return Map<Float>([&](size_t i) {
+    float f;
+    std::memcpy(&f, &x.v[i], sizeof(f));
+    return f;
+  });
+}
+
+template <int bits> inline Int ShiftLeft(Int x) {
+  return Map<Int>([&](size_t i) { return x.v[i] << bits; });
+}
+template <int bits> inline Int ShiftRight(Int x) {
+  return Map<Int>([&](size_t i) { return x.v[i] >> bits; });
+}
+
+inline Int Truncate(Float x) {
+  return Map<Int>([&](size_t i) {
+    return static_cast<uint32_t>(static_cast<int32_t>(x.v[i]));
+  });
+}
+inline Float ToFloat(Int x) {
+  return Map<Float>(
+      [&](size_t i) { return static_cast<float>(static_cast<int32_t>(x.v[i])); });
+}
+
+inline Float Lookup(const float *table, Int index) {
+  return Map<Float>([&](size_t i) { return table[index.v[i]]; });
+}
+
+inline float Sum(Float x) {
+  float sum = 0.0f;
+  for (size_t i = 0; i < kNumLanes; ++i) {
+    sum += x.v[i];
+  }
+  return sum;
+}
+
+#endif // __AVX2__
+
+// Converts lanes within [0, 2^32) to uint32, as static_cast<uint32_t> would.
+// The hardware only converts to int32, so the range is shifted by 2^31. The
+// shift is exact, and the result identical to the scalar cast, for x >= 2^30.
+inline Int TruncateUnsigned(Float x) {
+  return Add(Truncate(Sub(x, Set(2147483648.0f))), Set(uint32_t{0x80000000}));
+}
+
+} // namespace simd
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_SIMD_H_
@@ -27,6 +27,7 @@
 // Main synthesis voice.
 
 #include "plaits/dsp/voice.h"
+#include "plaits/fm_patch_sysex.hh"
 #include "plaits/user_data.h"
 
 namespace plaits {
@@ -34,6 +35,13 @@ namespace plaits {
 using namespace std;
 using namespace stmlib;
 
+static_assert(
+    VoiceEngineRegistry::kMaxStateSize <= PLAITS_ENGINE_STATE_BUDGET,
+    "An engine exceeds PLAITS_ENGINE_STATE_BUDGET");
+static_assert(
+    sizeof(Voice) + Voice::kSharedRamSize <= PLAITS_VOICE_RAM_BUDGET,
+    "The voice exceeds PLAITS_VOICE_RAM_BUDGET");
+
 void Voice::Init(BufferAllocator* allocator) {
   engines_.Init();
 
@@ -67,24 +75,147 @@ void Voice::Init(BufferAllocator* allocator) {
   for (int i = 0; i < engines_.size(); ++i) {
     // All engines will share the same RAM space.
     allocator->Free();
-    engines_.get(i)->Init(allocator);
+    size_t free = allocator->free();
+    engines_.Dispatch(i, [allocator](auto& e) { InitEngine(e, allocator); });
+    uses_shared_ram_[i] = allocator->free() != free;
+    
+    instance_mask_[i] = 0;
+    for (int j = 0; j < engines_.size(); ++j) {
+      if (engines_.same_instance(i, j)) {
+        instance_mask_[i] |= 1 << j;
+      }
+    }
   }
+  fade_engine_index_ = -1;
+  fade_position_ = 0;
+  shadow_engine_.store(-1);
+  busy_engines_.store(0);
   
   engine_quantizer_.Init(engines_.size(), 0.05f, true);
   previous_engine_index_ = -1;
   reload_user_data_ = false;
   engine_cv_ = 0.0f;
   
-  out_post_processor_.Init();
-  aux_post_processor_.Init();
+  for (int i = 0; i < 2; ++i) {
+    post_processor_[i][0].Init();
+    post_processor_[i][1].Init();
+  }
+  active_post_processor_ = 0;
 
-  decay_envelope_.Init();
-  lpg_envelope_.Init();
+  decay_envelope_ = {};
+  lpg_envelope_ = {};
   
   trigger_state_ = false;
   previous_note_ = 0.0f;
   
-  trigger_delay_.Init(trigger_delay_line_);
+  trigger_delay_.Reset();
+  
+  ClearEvents();
+  num_dropped_events_ = 0;
+}
+
+void Voice::ClearEvents() {
+  events_.Init();
+  fill(&event_value_[0], &event_value_[VOICE_EVENT_LAST], 0.0f);
+  fill(&event_received_[0], &event_received_[VOICE_EVENT_LAST], false);
+}
+
+void Voice::LoadEngine(int engine_index) {
+  UserData user_data;
+  const uint8_t* data = user_data.ptr(engine_index);
+  if (!data && engine_index >= 2 && engine_index <= 4) {
+    data = fm_patches_table[engine_index - 2];
+  }
+  engines_.Dispatch(engine_index, [data](auto& e) {
+    e.LoadUserData(data);
+    e.Reset();
+  });
+}
+
+bool Voice::PrepareEngine(int engine_index) {
+  if (engine_index < 0 || engine_index >= engines_.size() || \
+      uses_shared_ram_[engine_index]) {
+    return false;
+  }
+  int state = shadow_engine_.load();
+  if (state >= 0 && state < kMaxEngines) {
+    return false;
+  }
+  if (!shadow_engine_.compare_exchange_strong(state, engine_index)) {
+    return false;
+  }
+  
+  // The audio thread publishes the engines it uses before looking at
+  // shadow_engine_, so either it sees our claim and waits for us, or we see
+  // it is using the engine and back off.
+  if (busy_engines_.load() & instance_mask_[engine_index]) {
+    shadow_engine_.store(-1);
+    return false;
+  }
+  LoadEngine(engine_index);
+  shadow_engine_.store(engine_index + kMaxEngines);
+  return true;
+}
+
+void Voice::UpdateBusyEngines() {
+  uint32_t busy = 0;
+  if (previous_engine_index_ != -1) {
+    busy |= instance_mask_[previous_engine_index_];
+  }
+  if (fade_engine_index_ != -1) {
+    busy |= instance_mask_[fade_engine_index_];
+  }
+  busy_engines_.store(busy);
+}
+
+// Returns false if the engine is being prepared by another thread, in which
+// case the switch is postponed to the next segment.
+bool Voice::SwitchEngine(int engine_index) {
+  uint32_t busy = busy_engines_.load() | instance_mask_[engine_index];
+  busy_engines_.store(busy);
+  
+  int state = shadow_engine_.load();
+  if (state >= 0 && state < kMaxEngines) {
+    if (instance_mask_[engine_index] & (1 << state)) {
+      UpdateBusyEngines();
+      return false;
+    }
+  } else if (state >= kMaxEngines) {
+    int prepared = state - kMaxEngines;
+    bool claim = prepared == engine_index && !reload_user_data_;
+    if (claim || instance_mask_[engine_index] & (1 << prepared)) {
+      // Either the engine is ready, or we are going to reload the instance
+      // it shares with the prepared engine, invalidating the preparation.
+      if (shadow_engine_.compare_exchange_strong(state, -1) && claim) {
+        return true;
+      }
+    }
+  }
+  LoadEngine(engine_index);
+  return true;
+}
+
+void Voice::Crossfade(size_t size) {
+  const float scale = 0.5f * float(M_PI) / float(kEngineCrossfadeSize);
+  
+  for (size_t i = 0; i < size; ++i) {
+    const float x = float(min(fade_position_, kEngineCrossfadeSize)) * scale;
+    const float fade_in = sinf(x);
+    const float fade_out = cosf(x);
+    out_buffer_[i] = out_buffer_[i] * fade_in + fade_out_buffer_[i] * fade_out;
+    aux_buffer_[i] = aux_buffer_[i] * fade_in + fade_aux_buffer_[i] * fade_out;
+    ++fade_position_;
+  }
+  
+  if (fade_position_ >= kEngineCrossfadeSize) {
+    fade_engine_index_ = -1;
+    UpdateBusyEngines();
+  }
+}
+
+void Voice::ApplyEvent(const VoiceEvent& event) {
+  event_value_[event.type] = event.value;
+  event_received_[event.type] = true;
 }
 
 void Voice::Render(
@@ -92,13 +223,55 @@ void Voice::Render(
     const Modulations& modulations,
     Frame* frames,
     size_t size) {
-  // Trigger, LPG, internal envelope.
-      
-  // Delay trigger by 1ms to deal with sequencers or MIDI interfaces whose
-  // CV out lags behind the GATE out.
-  trigger_delay_.Write(modulations.trigger);
-  float trigger_value = trigger_delay_.Read(kTriggerDelay);
+  Modulations m = modulations;
   
+  while (size) {
+    const size_t block_size = min(size, kMaxBlockSize);
+    
+    // Delay trigger by 1ms to deal with sequencers or MIDI interfaces whose
+    // CV out lags behind the GATE out.
+    trigger_delay_.Write(modulations.trigger);
+    const float delayed_trigger = trigger_delay_.Read(kTriggerDelay);
+    
+    // Split the block at the events' timestamps.
+    size_t start = 0;
+    while (start < block_size) {
+      while (!events_.empty() && events_.front().sample <= start) {
+        ApplyEvent(events_.front());
+        events_.Pop();
+      }
+      size_t end = block_size;
+      if (!events_.empty()) {
+        end = min(events_.front().sample, block_size);
+      }
+      
+      if (event_received_[VOICE_EVENT_NOTE]) {
+        m.note = event_value_[VOICE_EVENT_NOTE];
+      }
+      if (event_received_[VOICE_EVENT_LEVEL]) {
+        m.level = event_value_[VOICE_EVENT_LEVEL];
+      }
+      const float trigger_value = event_received_[VOICE_EVENT_TRIGGER]
+          ? event_value_[VOICE_EVENT_TRIGGER]
+          : delayed_trigger;
+      
+      RenderSegment(patch, m, trigger_value, frames + start, end - start);
+      start = end;
+    }
+    events_.Advance(block_size);
+    
+    frames += block_size;
+    size -= block_size;
+  }
+}
+
+void Voice::RenderSegment(
+    const Patch& patch,
+    const Modulations& modulations,
+    float trigger_value,
+    Frame* frames,
+    size_t size) {
+  // Trigger, LPG, internal envelope.
   bool previous_trigger_state = trigger_state_;
   if (!previous_trigger_state) {
     if (trigger_value > 0.3f) {
@@ -123,27 +296,42 @@ void Voice::Render(
       patch.engine,
       engine_cv_);
   
-  Engine* e = engines_.get(engine_index);
-  
   if (engine_index != previous_engine_index_ || reload_user_data_) {
-    UserData user_data;
-    const uint8_t* data = user_data.ptr(engine_index);
-    if (!data && engine_index >= 2 && engine_index <= 4) {
-      data = fm_patches_table[engine_index - 2];
+    if (SwitchEngine(engine_index)) {
+      const int from = previous_engine_index_;
+      const bool crossfade = from != -1 && \
+          !engines_.same_instance(from, engine_index) && \
+          !(uses_shared_ram_[from] && uses_shared_ram_[engine_index]);
+      fade_engine_index_ = crossfade ? from : -1;
+      fade_position_ = 0;
+      
+      if (crossfade) {
+        // The outgoing engine keeps the post-processors it was using.
+        active_post_processor_ ^= 1;
+        post_processor_[active_post_processor_][0].Init();
+        post_processor_[active_post_processor_][1].Init();
+      } else {
+        post_processor_[active_post_processor_][0].Reset();
+      }
+      previous_engine_index_ = engine_index;
+      reload_user_data_ = false;
+      UpdateBusyEngines();
+    } else {
+      engine_index = previous_engine_index_;
     }
-    e->LoadUserData(data);
-    e->Reset();
-
-    out_post_processor_.Reset();
-    previous_engine_index_ = engine_index;
-    reload_user_data_ = false;
+  }
+  if (engine_index == -1) {
+    // The very first engine is still being prepared by another thread.
+    fill(&frames[0], &frames[size], Frame());
+    return;
   }
   EngineParameters p;
 
   bool rising_edge = trigger_state_ && !previous_trigger_state;
   float note = (modulations.note + previous_note_) * 0.5f;
   previous_note_ = modulations.note;
-  const PostProcessingSettings& pp_s = e->post_processing_settings;
+  const PostProcessingSettings& pp_s = \
+      engines_.post_processing_settings(engine_index);
 
   if (modulations.trigger_patched) {
     p.trigger = (rising_edge ? TRIGGER_RISING_EDGE : TRIGGER_LOW) | \
@@ -152,7 +340,9 @@ void Voice::Render(
     p.trigger = TRIGGER_UNPATCHED;
   }
   
-  const float short_decay = (200.0f * kBlockSize) / kSampleRate *
+  // Envelope rates are scaled by the segment size, since blocks can be split
+  // at event boundaries.
+  const float short_decay = (200.0f * size) / kSampleRate *
       SemitonesToRatio(-96.0f * patch.decay);
 
   decay_envelope_.Process(short_decay * 2.0f);
@@ -169,25 +359,9 @@ void Voice::Render(
   CONSTRAIN(p.harmonics, 0.0f, 1.0f);
 
   float internal_envelope_amplitude = 1.0f;
-  float internal_envelope_amplitude_timbre = 1.0f;
   if (engine_index == 15) {
     internal_envelope_amplitude = 2.0f - p.harmonics * 6.0f;
     CONSTRAIN(internal_envelope_amplitude, 0.0f, 1.0f);
-    speech_engine_.set_prosody_amount(
-        !modulations.trigger_patched || modulations.frequency_patched ?
-            0.0f : patch.frequency_modulation_amount);
-    speech_engine_.set_speed( 
-        !modulations.trigger_patched || modulations.morph_patched ?
-            0.0f : patch.morph_modulation_amount);
-  } else if (engine_index == 7) {
-    if (modulations.trigger_patched && !modulations.timbre_patched) {
-      // Disable internal envelope on TIMBRE, and enable the envelope generator
-      // built into the chiptune engine.
-      internal_envelope_amplitude_timbre = 0.0f;
-      chiptune_engine_.set_envelope_shape(patch.timbre_modulation_amount);
-    } else {
-      chiptune_engine_.set_envelope_shape(ChiptuneEngine::NO_ENVELOPE);
-    }
   }
   
   p.note = ApplyModulations(
@@ -208,7 +382,7 @@ void Voice::Render(
       modulations.timbre_patched,
       modulations.timbre,
       use_internal_envelope,
-      internal_envelope_amplitude_timbre * decay_envelope_.value(),
+      decay_envelope_.value(),
       0.0f,
       0.0f,
       1.0f);
@@ -225,48 +399,93 @@ void Voice::Render(
       1.0f);
 
   bool already_enveloped = pp_s.already_enveloped;
-  e->Render(p, out_buffer_, aux_buffer_, size, &already_enveloped);
+  engines_.Dispatch(engine_index, [&](auto& e) {
+    e.Render(p, out_buffer_, aux_buffer_, size, &already_enveloped);
+  });
+  
+  // The engine being faded out is post-processed with its own settings.
+  const bool fade = fade_engine_index_ != -1;
+  bool fade_already_enveloped = false;
+  if (fade) {
+    fade_already_enveloped = \
+        engines_.post_processing_settings(fade_engine_index_).already_enveloped;
+    engines_.Dispatch(fade_engine_index_, [&](auto& e) {
+      e.Render(
+          p,
+          fade_out_buffer_,
+          fade_aux_buffer_,
+          size,
+          &fade_already_enveloped);
+    });
+  }
   
-  bool lpg_bypass = already_enveloped || \
-      (!modulations.level_patched && !modulations.trigger_patched);
+  const bool lpg_always_bypassed = \
+      !modulations.level_patched && !modulations.trigger_patched;
+  bool lpg_bypass = already_enveloped || lpg_always_bypassed;
+  bool fade_lpg_bypass = fade_already_enveloped || lpg_always_bypassed;
   
   // Compute LPG parameters.
-  if (!lpg_bypass) {
+  if (!lpg_bypass || (fade && !fade_lpg_bypass)) {
     const float hf = patch.lpg_colour;
-    const float decay_tail = (20.0f * kBlockSize) / kSampleRate *
+    const float decay_tail = (20.0f * size) / kSampleRate *
         SemitonesToRatio(-72.0f * patch.decay + 12.0f * hf) - short_decay;
     
     if (modulations.level_patched) {
       lpg_envelope_.ProcessLP(compressed_level, short_decay, decay_tail, hf);
     } else {
-      const float attack = NoteToFrequency(p.note) * float(kBlockSize) * 2.0f;
+      const float attack = NoteToInc(p.note) * float(size) * 2.0f;
       lpg_envelope_.ProcessPing(attack, short_decay, decay_tail, hf);
     }
   } else {
-    lpg_envelope_.Init();
+    lpg_envelope_ = {};
   }
   
-  out_post_processor_.Process(
+  ChannelPostProcessor* pp = post_processor_[active_post_processor_];
+  pp[0].Process(
       pp_s.out_gain,
       lpg_bypass,
       lpg_envelope_.gain(),
       lpg_envelope_.frequency(),
       lpg_envelope_.hf_bleed(),
       out_buffer_,
-      &frames->out,
-      size,
-      2);
+      size);
 
-  aux_post_processor_.Process(
+  pp[1].Process(
       pp_s.aux_gain,
       lpg_bypass,
       lpg_envelope_.gain(),
       lpg_envelope_.frequency(),
       lpg_envelope_.hf_bleed(),
       aux_buffer_,
-      &frames->aux,
-      size,
-      2);
+      size);
+  
+  if (fade) {
+    const PostProcessingSettings& fade_pp_s = \
+        engines_.post_processing_settings(fade_engine_index_);
+    ChannelPostProcessor* fade_pp = post_processor_[active_post_processor_ ^ 1];
+    fade_pp[0].Process(
+        fade_pp_s.out_gain,
+        fade_lpg_bypass,
+        lpg_envelope_.gain(),
+        lpg_envelope_.frequency(),
+        lpg_envelope_.hf_bleed(),
+        fade_out_buffer_,
+        size);
+    fade_pp[1].Process(
+        fade_pp_s.aux_gain,
+        fade_lpg_bypass,
+        lpg_envelope_.gain(),
+        lpg_envelope_.frequency(),
+        lpg_envelope_.hf_bleed(),
+        fade_aux_buffer_,
+        size);
+    Crossfade(size);
+  }
+  
+  for (size_t i = 0; i < size; ++i) {
+    frames[i].out = Clip16(1 + static_cast<int32_t>(out_buffer_[i]));
+    frames[i].aux = Clip16(1 + static_cast<int32_t>(aux_buffer_[i]));
+  }
 }
   
 }  // namespace plaits
@@ -29,6 +29,8 @@
 #ifndef PLAITS_DSP_VOICE_H_
 #define PLAITS_DSP_VOICE_H_
 
+#include <atomic>
+
 #include "stmlib/stmlib.h"
 
 #include "stmlib/dsp/filter.h"
@@ -69,6 +71,19 @@ namespace plaits {
 const int kMaxEngines = 24;
 const int kMaxTriggerDelay = 8;
 const int kTriggerDelay = 5;
+const size_t kEngineCrossfadeSize = static_cast<size_t>(kSampleRate * 0.005f);
+
+// Memory budgets, checked at compile time in voice.cc. The largest engine
+// object, and the whole voice including the RAM shared by its engines. Targets
+// with more or less RAM can override them; plaits_memory reports the actual
+// figures.
+#ifndef PLAITS_ENGINE_STATE_BUDGET
+#define PLAITS_ENGINE_STATE_BUDGET (24 * 1024)
+#endif  // PLAITS_ENGINE_STATE_BUDGET
+
+#ifndef PLAITS_VOICE_RAM_BUDGET
+#define PLAITS_VOICE_RAM_BUDGET (64 * 1024)
+#endif  // PLAITS_VOICE_RAM_BUDGET
 
 class ChannelPostProcessor {
  public:
@@ -76,7 +91,7 @@ class ChannelPostProcessor {
   ~ChannelPostProcessor() { }
   
   void Init() {
-    lpg_.Init();
+    lpg_ = {};
     Reset();
   }
   
@@ -84,18 +99,17 @@ class ChannelPostProcessor {
     limiter_.Init();
   }
   
+  // Processes the signal in place, and scales it to the range of a short.
   void Process(
       float gain,
       bool bypass_lpg,
       float low_pass_gate_gain,
       float low_pass_gate_frequency,
       float low_pass_gate_hf_bleed,
-      float* in,
-      short* out,
-      size_t size,
-      size_t stride) {
+      float* in_out,
+      size_t size) {
     if (gain < 0.0f) {
-      limiter_.Process(-gain, in, size);
+      limiter_.Process(-gain, in_out, size);
     }
     const float post_gain = (gain < 0.0f ? 1.0f : gain) * -32767.0f;
     if (!bypass_lpg) {
@@ -103,14 +117,11 @@ class ChannelPostProcessor {
           post_gain * low_pass_gate_gain,
           low_pass_gate_frequency,
           low_pass_gate_hf_bleed,
-          in,
-          out,
-          size,
-          stride);
+          in_out,
+          size);
     } else {
       while (size--) {
-        *out = stmlib::Clip16(1 + static_cast<int32_t>(*in++ * post_gain));
-        out += stride;
+        *in_out++ *= post_gain;
       }
     }
   }
@@ -153,7 +164,98 @@ struct Modulations {
   bool level_patched;
 };
 
-// char (*__foo)[sizeof(HiHatEngine)] = 1;
+enum VoiceEventType {
+  VOICE_EVENT_TRIGGER,
+  VOICE_EVENT_NOTE,
+  VOICE_EVENT_LEVEL,
+  VOICE_EVENT_LAST
+};
+
+// Timestamped change of one of the trigger, note or level modulations. Once
+// an event of a given type has been received, its value replaces the
+// corresponding field of Modulations, until Voice::ClearEvents() is called.
+// Trigger events are not delayed.
+struct VoiceEvent {
+  size_t sample;  // Relative to the start of the next rendered block.
+  VoiceEventType type;
+  float value;
+};
+
+const size_t kMaxVoiceEvents = 32;
+
+class VoiceEventQueue {
+ public:
+  VoiceEventQueue() { }
+  ~VoiceEventQueue() { }
+  
+  void Init() {
+    size_ = 0;
+  }
+  
+  // Events are kept sorted by time. Events with the same timestamp are
+  // applied in the order in which they have been pushed.
+  bool Push(const VoiceEvent& event) {
+    if (size_ == kMaxVoiceEvents) {
+      return false;
+    }
+    size_t i = size_;
+    while (i > 0 && events_[i - 1].sample > event.sample) {
+      events_[i] = events_[i - 1];
+      --i;
+    }
+    events_[i] = event;
+    ++size_;
+    return true;
+  }
+  
+  inline void Pop() {
+    --size_;
+    for (size_t i = 0; i < size_; ++i) {
+      events_[i] = events_[i + 1];
+    }
+  }
+  
+  // Moves the remaining events to the time frame of the next block.
+  inline void Advance(size_t size) {
+    for (size_t i = 0; i < size_; ++i) {
+      events_[i].sample -= std::min(events_[i].sample, size);
+    }
+  }
+  
+  inline bool empty() const { return size_ == 0; }
+  inline size_t available() const { return kMaxVoiceEvents - size_; }
+  inline const VoiceEvent& front() const { return events_[0]; }
+  
+ private:
+  VoiceEvent events_[kMaxVoiceEvents];
+  size_t size_;
+  
+  DISALLOW_COPY_AND_ASSIGN(VoiceEventQueue);
+};
+
+typedef EngineRegistry<kMaxEngines,
+    VirtualAnalogVCFEngine,
+    PhaseDistortionEngine,
+    SixOpEngine,
+    WaveTerrainEngine,
+    StringMachineEngine,
+    ChiptuneEngine,
+    VirtualAnalogEngine,
+    WaveshapingEngine,
+    FMEngine,
+    GrainEngine,
+    AdditiveEngine,
+    WavetableEngine,
+    ChordEngine,
+    NaiveSpeechEngine,
+    SwarmEngine,
+    NoiseEngine,
+    ParticleEngine,
+    StringEngine,
+    ModalEngine,
+    BassDrumEngine,
+    SnareDrumEngine,
+    HiHatEngine> VoiceEngineRegistry;
 
 
 class Voice {
@@ -166,10 +268,42 @@ class Voice {
     short aux;
   };
   
+  // Size of the RAM to hand to Init(): the largest amount used by an engine.
+  static const size_t kSharedRamSize = VoiceEngineRegistry::kMaxSharedRamSize;
+  
   void Init(stmlib::BufferAllocator* allocator);
   void ReloadUserData() {
     reload_user_data_ = true;
   }
+  
+  // Loads the user data of an engine and resets it, from a thread other than
+  // the audio thread, so that switching to it later is free. Returns false
+  // when the engine cannot be prepared in the background: it is being
+  // rendered, another engine is being prepared, or it keeps state in the
+  // RAM shared by the engines. It is then prepared by Render() when selected.
+  bool PrepareEngine(int engine_index);
+  
+  // Returns false if the queue is full. The event is then dropped, and
+  // counted in num_dropped_events().
+  bool ScheduleEvent(const VoiceEvent& event) {
+    if (!events_.Push(event)) {
+      ++num_dropped_events_;
+      return false;
+    }
+    return true;
+  }
+  
+  // Discards the scheduled events, and hands the trigger, note and level
+  // back to Modulations.
+  void ClearEvents();
+  
+  inline size_t num_dropped_events() const { return num_dropped_events_; }
+  
+  // Number of events that can still be scheduled before the next Render().
+  inline size_t num_free_events() const { return events_.available(); }
+  
+  // Renders size samples (size is not limited to kMaxBlockSize). The block is
+  // split at the timestamps of the scheduled events.
   void Render(
       const Patch& patch,
       const Modulations& modulations,
@@ -178,6 +312,18 @@ class Voice {
   inline int active_engine() const { return previous_engine_index_; }
     
  private:
+  void ApplyEvent(const VoiceEvent& event);
+  void LoadEngine(int engine_index);
+  bool SwitchEngine(int engine_index);
+  void Crossfade(size_t size);
+  void UpdateBusyEngines();
+  void RenderSegment(
+      const Patch& patch,
+      const Modulations& modulations,
+      float trigger_value,
+      Frame* frames,
+      size_t size);
+  
   void ComputeDecayParameters(const Patch& settings);
   
   inline float ApplyModulations(
@@ -209,7 +355,7 @@ class Voice {
   AdditiveEngine additive_engine_;
   WavetableEngine wavetable_engine_;
   ChordEngine chord_engine_;
-  SpeechEngine speech_engine_;
+  NaiveSpeechEngine speech_engine_;
 
   SwarmEngine swarm_engine_;
   NoiseEngine noise_engine_;
@@ -231,6 +377,23 @@ class Voice {
   
   bool reload_user_data_;
   int previous_engine_index_;
+  
+  // Engine switching. Engines are crossfaded over kEngineCrossfadeSize
+  // samples, unless they both use the shared RAM, in which case they cannot
+  // be rendered in the same block. The outgoing engine keeps its own
+  // post-processors (limiter and LPG state) until the end of the crossfade.
+  //
+  // shadow_engine_ is the engine being prepared by PrepareEngine (0 to
+  // kMaxEngines - 1), the engine that has been prepared (kMaxEngines to
+  // 2 * kMaxEngines - 1), or -1. busy_engines_ has one bit set for each
+  // engine the audio thread renders or is switching to; engines registered
+  // several times set all their bits.
+  int fade_engine_index_;
+  size_t fade_position_;
+  std::atomic<int> shadow_engine_;
+  std::atomic<uint32_t> busy_engines_;
+  uint32_t instance_mask_[kMaxEngines];
+  bool uses_shared_ram_[kMaxEngines];
   float engine_cv_;
   
   float previous_note_;
@@ -239,16 +402,24 @@ class Voice {
   DecayEnvelope decay_envelope_;
   LPGEnvelope lpg_envelope_;
   
-  float trigger_delay_line_[kMaxTriggerDelay];
   DelayLine<float, kMaxTriggerDelay> trigger_delay_;
   
-  ChannelPostProcessor out_post_processor_;
-  ChannelPostProcessor aux_post_processor_;
+  VoiceEventQueue events_;
+  float event_value_[VOICE_EVENT_LAST];
+  bool event_received_[VOICE_EVENT_LAST];
+  size_t num_dropped_events_;
+  
+  // Two pairs of out/aux post-processors: the current engine's, and those of
+  // the engine being faded out. They swap roles when a crossfade starts.
+  ChannelPostProcessor post_processor_[2][2];
+  int active_post_processor_;
   
-  EngineRegistry<kMaxEngines> engines_;
+  VoiceEngineRegistry engines_;
   
   float out_buffer_[kMaxBlockSize];
   float aux_buffer_[kMaxBlockSize];
+  float fade_out_buffer_[kMaxBlockSize];
+  float fade_aux_buffer_[kMaxBlockSize];
   
   DISALLOW_COPY_AND_ASSIGN(Voice);
 };
@@ -0,0 +1,274 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Polyphonic pool of voices with note allocation and a shared mix bus.
+//
+// Only the per-voice state (engines, envelopes, post-processors, and a slice
+// of the engines' RAM) is duplicated. The lookup tables, wavetables, FM and LPC
+// banks are global constants and are shared by all voices.
+//
+// Per-voice memory cost: sizeof(Voice) + ram_size / num_voices, where ram_size
+// is the buffer given to Init(). The engines share their RAM slice, so a slice
+// must be at least Voice::kSharedRamSize bytes (kRamSize for the whole pool).
+
+#ifndef PLAITS_DSP_VOICE_POOL_H_
+#define PLAITS_DSP_VOICE_POOL_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+#include "stmlib/stmlib.h"
+#include "stmlib/utils/buffer_allocator.h"
+
+#include "core/random.hh"
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/dsp/voice.h"
+
+namespace plaits {
+
+// A released voice is put to sleep once its output has stayed below this
+// level for kIdleBlocks consecutive blocks.
+const int kIdleThreshold = 4;
+const int kIdleBlocks = 32;
+
+// Number of voice events scheduled by a note on (in the worst case) and by a
+// note off. Notes are only played or released if they fit in the queue.
+const size_t kNoteOnEvents = 4;
+const size_t kNoteOffEvents = 2;
+
+template <size_t num_voices>
+class VoicePool {
+public:
+  using Frame = Voice::Frame;
+
+  static constexpr size_t kNumVoices = num_voices;
+  static constexpr size_t kRamSize = Voice::kSharedRamSize * num_voices;
+
+  void Init(void *ram, size_t ram_size) {
+    const size_t slice_size = ram_size / num_voices;
+    uint8_t *slice = static_cast<uint8_t *>(ram);
+    for (size_t i = 0; i < num_voices; ++i) {
+      stmlib::BufferAllocator allocator(slice, slice_size);
+      voice_[i].Init(&allocator);
+      slice += slice_size;
+
+      modulations_[i] = Modulations{};
+      modulations_[i].trigger_patched = true;
+      modulations_[i].level_patched = true;
+
+      note_[i] = -1000.0f;
+      age_[i] = 0;
+      gate_[i] = false;
+      idle_[i] = true;
+      silent_blocks_[i] = 0;
+      num_blocks_[i] = 0;
+    }
+    ram_per_voice_ = slice_size;
+    counter_ = 0;
+  }
+
+  // Applies the same patch to all voices.
+  void set_patch(const Patch &patch) { patch_.fill(patch); }
+
+  Patch *mutable_patch(int voice) { return &patch_[voice]; }
+  Modulations *mutable_modulations(int voice) { return &modulations_[voice]; }
+
+  // Returns the index of the voice allocated to the note, or -1 if the event
+  // queue of that voice is full, in which case the note is not played. sample
+  // is the position of the note in the next rendered block.
+  int NoteOn(float note, float velocity, size_t sample = 0) {
+    int voice = Find(note);
+    if (voice == -1) {
+      voice = Allocate();
+    }
+    Voice &v = voice_[voice];
+    if (v.num_free_events() < kNoteOnEvents) {
+      return -1;
+    }
+    v.ScheduleEvent({sample, VOICE_EVENT_NOTE, note});
+    v.ScheduleEvent({sample, VOICE_EVENT_LEVEL, velocity});
+
+    // A voice that is still sounding needs to see a low trigger before the
+    // new rising edge is detected.
+    if (!idle_[voice]) {
+      v.ScheduleEvent({sample, VOICE_EVENT_TRIGGER, 0.0f});
+      ++sample;
+    }
+    v.ScheduleEvent({sample, VOICE_EVENT_TRIGGER, 1.0f});
+
+    note_[voice] = note;
+    age_[voice] = ++counter_;
+    gate_[voice] = true;
+    idle_[voice] = false;
+    silent_blocks_[voice] = 0;
+    return voice;
+  }
+
+  // Returns false if the note could not be released on all the voices playing
+  // it because their event queue is full. These voices keep their gate high.
+  bool NoteOff(float note, size_t sample = 0) {
+    bool success = true;
+    for (size_t i = 0; i < num_voices; ++i) {
+      if (gate_[i] && note_[i] == note) {
+        if (voice_[i].num_free_events() < kNoteOffEvents) {
+          success = false;
+          continue;
+        }
+        voice_[i].ScheduleEvent({sample, VOICE_EVENT_TRIGGER, 0.0f});
+        voice_[i].ScheduleEvent({sample, VOICE_EVENT_LEVEL, 0.0f});
+        gate_[i] = false;
+        age_[i] = ++counter_;
+      }
+    }
+    return success;
+  }
+
+  bool AllNotesOff() {
+    bool success = true;
+    for (size_t i = 0; i < num_voices; ++i) {
+      if (gate_[i]) {
+        success = NoteOff(note_[i]) && success;
+      }
+    }
+    return success;
+  }
+
+  // Renders and mixes all active voices. size must be <= kMaxBlockSize.
+  // Notes are played with sample accuracy within the block.
+  void Render(float *out, float *aux, size_t size) {
+    std::fill(&out[0], &out[size], 0.0f);
+    std::fill(&aux[0], &aux[size], 0.0f);
+    for (size_t i = 0; i < num_voices; ++i) {
+      RenderVoice(i, frames_, out, aux, size);
+    }
+  }
+
+  // Renders a single voice and adds it to the bus. frames is scratch space for
+  // the voice's output: voices rendered concurrently need distinct buffers.
+  void RenderVoice(size_t i, Frame *frames, float *out, float *aux,
+                   size_t size) {
+    if (idle_[i]) {
+      return;
+    }
+
+    // The engines draw their noise from ToySynth::Random, whose state belongs
+    // to the thread. Reseeding it from the voice and its block count makes the
+    // noise of a voice the same whichever thread renders it.
+    ToySynth::Random::seed(RandomSeed(i, ++num_blocks_[i]));
+    voice_[i].Render(patch_[i], modulations_[i], frames, size);
+
+    int peak = 0;
+    for (size_t j = 0; j < size; ++j) {
+      out[j] += static_cast<float>(frames[j].out) / 32768.0f;
+      aux[j] += static_cast<float>(frames[j].aux) / 32768.0f;
+      peak = std::max(peak, std::max<int>(std::abs(frames[j].out), std::abs(frames[j].aux)));
+    }
+
+    if (!gate_[i] && peak <= kIdleThreshold) {
+      if (++silent_blocks_[i] >= kIdleBlocks) {
+        idle_[i] = true;
+      }
+    } else {
+      silent_blocks_[i] = 0;
+    }
+  }
+
+  inline bool active(int voice) const { return !idle_[voice]; }
+  inline int active_engine(int voice) const {
+    return voice_[voice].active_engine();
+  }
+
+  size_t num_active_voices() const {
+    return std::count(idle_.begin(), idle_.end(), false);
+  }
+
+  // Memory used by one voice: its state, and its slice of the engines' RAM.
+  size_t memory_per_voice() const { return sizeof(Voice) + ram_per_voice_; }
+
+private:
+  // Mixes the voice index and the block count, so that the streams drawn by
+  // different voices and blocks are not correlated (MurmurHash3 finalizer).
+  static uint32_t RandomSeed(size_t voice, uint32_t block) {
+    uint32_t h = block * 0x9e3779b9u + static_cast<uint32_t>(voice);
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+  }
+
+  int Find(float note) const {
+    for (size_t i = 0; i < num_voices; ++i) {
+      if (!idle_[i] && note_[i] == note) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Picks an idle voice, then the voice released the longest time ago, and
+  // steals the oldest held note as a last resort.
+  int Allocate() const {
+    int released = -1;
+    int held = -1;
+    for (size_t i = 0; i < num_voices; ++i) {
+      if (idle_[i]) {
+        return i;
+      }
+      if (!gate_[i]) {
+        if (released == -1 || age_[i] < age_[released]) {
+          released = i;
+        }
+      } else if (held == -1 || age_[i] < age_[held]) {
+        held = i;
+      }
+    }
+    return released != -1 ? released : held;
+  }
+
+  std::array<Voice, num_voices> voice_;
+  std::array<Patch, num_voices> patch_{};
+  std::array<Modulations, num_voices> modulations_{};
+
+  std::array<float, num_voices> note_{};
+  std::array<uint32_t, num_voices> age_{};
+  std::array<bool, num_voices> gate_{};
+  std::array<bool, num_voices> idle_{};
+  std::array<int, num_voices> silent_blocks_{};
+  // Blocks rendered by each voice, to seed the random generator.
+  std::array<uint32_t, num_voices> num_blocks_{};
+
+  uint32_t counter_{};
+  size_t ram_per_voice_{};
+
+  Frame frames_[kMaxBlockSize];
+};
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_VOICE_POOL_H_
@@ -0,0 +1,237 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+//
+// Renders the voices of a VoicePool on a fixed set of worker threads.
+//
+// Each worker owns a contiguous range of voices and steals voices from the
+// other ranges once its own is exhausted. Each worker has its own scratch
+// frames, every voice is mixed into its own buffer, and the buffers are summed
+// on the calling thread in voice order, so the mix is bit-identical to
+// VoicePool::Render() whatever the thread count. This includes the noise of
+// the engines: VoicePool::RenderVoice() seeds the thread's random generator
+// for each voice and block.
+//
+// The per-voice Patch and Modulations are written by the caller before
+// Render(), and published to the workers by the release/acquire ordering of
+// the block counter: no locks are taken in the audio path.
+
+#ifndef PLAITS_DSP_VOICE_POOL_RENDERER_H_
+#define PLAITS_DSP_VOICE_POOL_RENDERER_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif // __linux__
+
+#include "plaits/dsp/dsp.h"
+
+namespace plaits {
+
+const size_t kMaxRenderThreads = 16;
+
+struct RenderStats {
+  uint32_t num_blocks;
+  uint32_t num_deadline_misses;
+  float last_block_load;  // Render time / block duration.
+  float peak_block_load;
+};
+
+template <typename Pool>
+class VoicePoolRenderer {
+public:
+  static constexpr size_t kNumVoices = Pool::kNumVoices;
+
+  ~VoicePoolRenderer() { Stop(); }
+
+  // num_threads includes the calling thread. With pin_threads, worker i is
+  // pinned to core i; the calling thread belongs to the host, and is left
+  // where it is. The load of each block is checked against its real-time
+  // deadline in stats().
+  void Init(Pool *pool, size_t num_threads, bool pin_threads) {
+    Stop();
+    pool_ = pool;
+    num_threads_ = std::clamp<size_t>(num_threads, 1, kMaxRenderThreads);
+    num_threads_ = std::min(num_threads_, kNumVoices);
+    pin_threads_ = pin_threads;
+    stats_ = RenderStats{};
+    quit_.store(false);
+    block_.store(0);
+
+    for (size_t i = 0; i < num_threads_; ++i) {
+      range_[i].begin = kNumVoices * i / num_threads_;
+      range_[i].end = kNumVoices * (i + 1) / num_threads_;
+    }
+    for (size_t i = 1; i < num_threads_; ++i) {
+      thread_[i] = std::thread(&VoicePoolRenderer::Worker, this, i);
+    }
+  }
+
+  void Stop() {
+    quit_.store(true);
+    block_.fetch_add(1, std::memory_order_release);
+    block_.notify_all();
+    for (size_t i = 1; i < num_threads_; ++i) {
+      if (thread_[i].joinable()) {
+        thread_[i].join();
+      }
+    }
+    num_threads_ = 1;
+  }
+
+  // Renders and mixes all voices. size must be <= kMaxBlockSize.
+  void Render(float *out, float *aux, size_t size) {
+    auto start = std::chrono::steady_clock::now();
+
+    size_ = size;
+    for (size_t i = 0; i < num_threads_; ++i) {
+      range_[i].next.store(range_[i].begin, std::memory_order_relaxed);
+    }
+    pending_.store(num_threads_ - 1, std::memory_order_relaxed);
+    block_.fetch_add(1, std::memory_order_release);
+    block_.notify_all();
+
+    RenderVoices(0);
+
+    // Wait for all workers to be done with this block, not only for all
+    // voices to be rendered: nothing may still read the ranges when they are
+    // reset for the next block.
+    size_t pending = pending_.load(std::memory_order_acquire);
+    while (pending) {
+      pending_.wait(pending, std::memory_order_acquire);
+      pending = pending_.load(std::memory_order_acquire);
+    }
+
+    std::fill(&out[0], &out[size], 0.0f);
+    std::fill(&aux[0], &aux[size], 0.0f);
+    for (size_t i = 0; i < kNumVoices; ++i) {
+      if (!rendered_[i]) {
+        continue;
+      }
+      for (size_t j = 0; j < size; ++j) {
+        out[j] += out_[i][j];
+        aux[j] += aux_[i][j];
+      }
+    }
+
+    std::chrono::duration<float> elapsed = \
+        std::chrono::steady_clock::now() - start;
+    float load = elapsed.count() * kSampleRate / static_cast<float>(size);
+    ++stats_.num_blocks;
+    if (load > 1.0f) {
+      ++stats_.num_deadline_misses;
+    }
+    stats_.last_block_load = load;
+    stats_.peak_block_load = std::max(stats_.peak_block_load, load);
+  }
+
+  inline size_t num_threads() const { return num_threads_; }
+  inline const RenderStats &stats() const { return stats_; }
+
+private:
+  struct alignas(64) Range {
+    std::atomic<size_t> next;
+    size_t begin;
+    size_t end;
+  };
+
+  struct alignas(64) Frames {
+    typename Pool::Frame data[kMaxBlockSize];
+  };
+
+  void Worker(size_t index) {
+    if (pin_threads_) {
+      Pin(index);
+    }
+    uint32_t block = 0;
+    while (true) {
+      block_.wait(block, std::memory_order_acquire);
+      block = block_.load(std::memory_order_acquire);
+      if (quit_.load(std::memory_order_relaxed)) {
+        break;
+      }
+      RenderVoices(index);
+      if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        pending_.notify_one();
+      }
+    }
+  }
+
+  // Drains our own range first, then steals from the others.
+  void RenderVoices(size_t index) {
+    for (size_t n = 0; n < num_threads_; ++n) {
+      Range &r = range_[(index + n) % num_threads_];
+      while (true) {
+        size_t voice = r.next.fetch_add(1, std::memory_order_relaxed);
+        if (voice >= r.end) {
+          break;
+        }
+        std::fill(&out_[voice][0], &out_[voice][size_], 0.0f);
+        std::fill(&aux_[voice][0], &aux_[voice][size_], 0.0f);
+        rendered_[voice] = pool_->active(voice);
+        pool_->RenderVoice(
+            voice, frames_[index].data, out_[voice], aux_[voice], size_);
+      }
+    }
+  }
+
+  static void Pin(size_t core) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &cpu_set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#endif // __linux__
+  }
+
+  Pool *pool_{};
+  size_t num_threads_{1};
+  bool pin_threads_{};
+  size_t size_{};
+
+  std::array<Range, kMaxRenderThreads> range_{};
+  std::array<std::thread, kMaxRenderThreads> thread_{};
+
+  alignas(64) std::atomic<uint32_t> block_{};
+  alignas(64) std::atomic<size_t> pending_{};
+  std::atomic<bool> quit_{};
+
+  RenderStats stats_{};
+
+  std::array<Frames, kMaxRenderThreads> frames_{};
+  std::array<bool, kNumVoices> rendered_{};
+  float out_[kNumVoices][kMaxBlockSize];
+  float aux_[kNumVoices][kMaxBlockSize];
+};
+
+} // namespace plaits
+
+#endif // PLAITS_DSP_VOICE_POOL_RENDERER_H_
@@ -0,0 +1,82 @@
+#include <cstdint>
+
+namespace plaits {
+
+// Built-in voices of the 4-operator engine, in the VMEM format of the DX21,
+// DX100 and TX81Z bulk dumps (128 bytes per voice).
+inline constexpr uint8_t vmem_bank_0[] = {
+    // E.PIANO 1
+     31,   9,   5,   7,   3,  20,   4,  78,   4,  11,  31,  10,   8,   8,   0,  30,
+      5,  62,  42,  11,  31,   5,   3,   7,   0,  10,   2,  90,   4,  12,  31,   6,
+      4,   7,   0,  10,   2,  99,   4,  11,  44,  35,   0,   0,   0,   2,  24,   2,
+      0,   0,  40,  50,   0,   0,   0,   0,  50,  69,  46,  80,  73,  65,  78,  79,
+     32,  49,  32,  99,  99,  99,  50,  50,  50,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    // SYN BASS
+     31,  10,   6,   9,   0,   0,   2,  64,   4,  11,  31,  12,   0,   9,   6,   0,
+      3,  74,   0,  11,  31,  14,   0,   9,   5,   0,   3,  70,   4,  11,  31,   8,
+      4,   9,  10,   0,   1,  99,   0,  11,  48,  35,   0,   0,   0,   2,  24,   2,
+      0,   0,  40,  50,   0,   0,   0,   0,  50,  83,  89,  78,  32,  66,  65,  83,
+     83,  32,  32,  99,  99,  99,  50,  50,  50,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    // BRASS
+     14,   5,   0,   7,  11,   0,   3,  80,   4,  11,  15,   6,   0,   7,  12,   0,
+      3,  82,   4,  11,  16,   8,   0,   7,  13,   0,  65,  97,   4,  12,  16,   8,
+      0,   7,  13,   0,  65,  99,   4,  11,  52,  33,  30,   5,   0,  54,  24,   2,
+      0,   0,  40,  50,   0,   0,   0,   0,  50,  66,  82,  65,  83,  83,  32,  32,
+     32,  32,  32,  99,  99,  99,  50,  50,  50,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    // BELLS
+     31,   7,   4,   5,   0,   0,   4,  68,  14,  11,  31,   6,   3,   5,   0,   0,
+      4,  72,  12,  11,  31,   4,   2,   4,   0,   0,   2,  92,   4,  13,  31,   4,
+      2,   4,   0,   0,   2,  99,   4,  11,   4,  35,   0,   0,   0,   2,  24,   2,
+      0,   0,  40,  50,   0,   0,   0,   0,  50,  66,  69,  76,  76,  83,  32,  32,
+     32,  32,  32,  99,  99,  99,  50,  50,  50,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    // ORGAN
+     31,   0,   0,  12,  15,   0,   0,  80,  10,  11,  31,   0,   0,  12,  15,   0,
+      0,  85,   8,  11,  31,   0,   0,  12,  15,   0,   0,  90,   0,  11,  31,   0,
+      0,  12,  15,   0,   0,  92,   4,  11,   7,  60,   0,   0,  12,   6,  24,   2,
+      0,   0,  40,  50,   0,   0,   0,   0,  50,  79,  82,  71,  65,  78,  32,  32,
+     32,  32,  32,  99,  99,  99,  50,  50,  50,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    // STRINGS
+     10,   3,   0,   6,  12,   0,   2,  64,   4,   9,  10,   3,   0,   6,  12,   0,
+      2,  66,   4,  11,  11,   3,   0,   6,  13,   0,   0,  97,   4,  13,  11,   3,
+      0,   6,  13,   0,   0,  99,   4,  11,  36,  30,  45,   8,   0,  50,  24,   2,
+      0,   0,  40,  50,   0,   0,   0,   0,  50,  83,  84,  82,  73,  78,  71,  83,
+     32,  32,  32,  99,  99,  99,  50,  50,  50,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    // SYNC LEAD
+     31,   8,   0,   8,   9,   0,   0,  68,   4,  11,  31,   6,   0,   8,  11,   0,
+      2,  80,   8,  11,  31,   8,   0,   8,  10,   0,   2,  72,   4,  11,  31,   4,
+      0,   8,  13,   0,   1,  99,   4,  11,  56,  34,  40,   6,   0,  50,  24,   2,
+      0,   0,  40,  50,   0,   0,   0,   0,  50,  83,  89,  78,  67,  32,  76,  69,
+     65,  68,  32,  99,  99,  99,  50,  50,  50,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    // MARIMBA
+     31,  20,  16,  10,   0,   0,   5,  74,  12,  11,  31,  18,  14,  10,   0,   0,
+      5,  70,  13,  11,  31,  14,  10,   9,   0,   0,   3,  86,   4,  11,  31,  12,
+      9,   9,   0,   0,   3,  99,   4,  11,   4,  35,   0,   0,   0,   2,  24,   2,
+      0,   0,  40,  50,   0,   0,   0,   0,  50,  77,  65,  82,  73,  77,  66,  65,
+     32,  32,  32,  99,  99,  99,  50,  50,  50,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+} // namespace plaits
@@ -53,7 +53,9 @@ UserData user_data;
 UserDataReceiver user_data_receiver;
 Voice voice;
 
-char shared_buffer[16384];
+// RAM shared by the engines, followed by the user data receiver's buffer.
+const size_t kSharedBufferSize = Voice::kSharedRamSize + UserData::SIZE;
+char shared_buffer[kSharedBufferSize];
 uint32_t test_ramp;
 
 // Default interrupt handlers.
@@ -139,10 +141,10 @@ void Init() {
   IWDG_WriteAccessCmd(IWDG_WriteAccess_Enable);
   IWDG_SetPrescaler(IWDG_Prescaler_16);
   
-  BufferAllocator allocator(shared_buffer, 16384);
+  BufferAllocator allocator(shared_buffer, Voice::kSharedRamSize);
   voice.Init(&allocator);
   user_data_receiver.Init(
-      (uint8_t*)(&shared_buffer[16384 - UserData::SIZE]),
+      (uint8_t*)(&shared_buffer[Voice::kSharedRamSize]),
       UserData::SIZE);
   
   volatile size_t counter = 1000000;
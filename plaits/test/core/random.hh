@@ -0,0 +1,74 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+//
+// -----------------------------------------------------------------------------
+//
+// Seedable stand-in for the host's random generator, used by the test
+// programs so that renders involving noise are reproducible.
+
+#ifndef PLAITS_TEST_CORE_RANDOM_HH_
+#define PLAITS_TEST_CORE_RANDOM_HH_
+
+#include <cstdint>
+#include <type_traits>
+
+namespace ToySynth {
+
+class Random {
+public:
+  struct Unipolar {};
+  struct Bipolar {};
+
+  static void seed(uint32_t seed) { state_ = seed ? seed : 0x21; }
+
+  // Unipolar floats are in [0, 1), bipolar floats in [-1, 1). Integer types
+  // are uniformly distributed over their full range.
+  template <typename T, typename Distribution = Unipolar> static T get() {
+    const uint32_t word = next();
+    if constexpr (std::is_floating_point_v<T>) {
+      const T u = static_cast<T>(word >> 8) * (T(1) / T(16777216));
+      if constexpr (std::is_same_v<Distribution, Bipolar>) {
+        return u * T(2) - T(1);
+      } else {
+        return u;
+      }
+    } else {
+      return static_cast<T>(word);
+    }
+  }
+
+private:
+  static uint32_t next() {
+    // xorshift32.
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return state_;
+  }
+
+  static inline thread_local uint32_t state_{0x21};
+};
+
+} // namespace ToySynth
+
+#endif // PLAITS_TEST_CORE_RANDOM_HH_
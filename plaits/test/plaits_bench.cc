@@ -0,0 +1,583 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Microbenchmarks for all engines and the main DSP building blocks.
+//
+// Each case is rendered at several block sizes and parameter corners. The
+// output is one CSV line per measurement, so that results can be stored and
+// compared across commits:
+//
+//   name,corner,block_size,ns_per_sample,ns_per_sample_stddev,cycles_per_block
+//
+// cycles_per_block is read from the time-stamp counter, and is 0 on platforms
+// without one.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <xmmintrin.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_TSC
+#endif  // __x86_64__ || __i386__
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/dsp/engine2/four_op_engine.h"
+#include "plaits/dsp/engine2/strum_engine.h"
+#include "plaits/dsp/fm/algorithms.h"
+#include "plaits/dsp/fm/lfo.h"
+#include "plaits/dsp/fm/lfo_bank.h"
+#include "plaits/dsp/fm/patch.h"
+#include "plaits/dsp/fm/voice.h"
+#include "plaits/dsp/oscillator/harmonic_oscillator.h"
+#include "plaits/dsp/oscillator/oscillator.h"
+#include "plaits/dsp/oscillator/sine_oscillator.h"
+#include "plaits/dsp/oscillator/wavetable_oscillator.h"
+#include "plaits/dsp/physical_modelling/resonator.h"
+#include "plaits/dsp/physical_modelling/string.h"
+#include "plaits/dsp/physical_modelling/string_bank.h"
+#include "plaits/dsp/physical_modelling/string_voice.h"
+#include "plaits/dsp/voice.h"
+#include "plaits/resources.h"
+
+using namespace std;
+using namespace stmlib;
+using namespace plaits;
+
+const int kNumRuns = 16;
+const float kRunDuration = 0.25f;  // In seconds of rendered audio.
+const int kTriggerPeriod = 200;  // In blocks.
+
+const size_t block_sizes[] = { 16, 24, 32, 64 };
+
+struct Corner {
+  const char* name;
+  float harmonics;
+  float timbre;
+  float morph;
+  float note;
+};
+
+const Corner corners[] = {
+  { "low", 0.0f, 0.0f, 0.0f, 24.0f },
+  { "mid", 0.5f, 0.5f, 0.5f, 48.0f },
+  { "high", 1.0f, 1.0f, 1.0f, 96.0f },
+};
+
+char ram_block[64 * 1024];
+
+inline uint64_t Cycles() {
+#ifdef HAS_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif  // HAS_TSC
+}
+
+// Times fn(size, block_index), called for kRunDuration seconds of audio, over
+// kNumRuns runs (after a warm-up run), and prints the statistics.
+template<typename F>
+void Measure(const char* name, const char* corner, size_t size, F&& fn) {
+  const size_t num_blocks = static_cast<size_t>(
+      kRunDuration * kSampleRate / size);
+  double ns_per_sample[kNumRuns];
+  double cycles_per_block = 0.0;
+
+  for (int run = -1; run < kNumRuns; ++run) {
+    uint64_t start_cycles = Cycles();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < num_blocks; ++i) {
+      fn(size, i);
+    }
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+    uint64_t cycles = Cycles() - start_cycles;
+    if (run >= 0) {
+      ns_per_sample[run] = elapsed.count() / (num_blocks * size);
+      cycles_per_block += double(cycles) / num_blocks / kNumRuns;
+    }
+  }
+  
+  double mean = 0.0;
+  for (int run = 0; run < kNumRuns; ++run) {
+    mean += ns_per_sample[run] / kNumRuns;
+  }
+  double variance = 0.0;
+  for (int run = 0; run < kNumRuns; ++run) {
+    double d = ns_per_sample[run] - mean;
+    variance += d * d / (kNumRuns - 1);
+  }
+  printf("%s,%s,%zu,%.3f,%.3f,%.0f\n",
+      name, corner, size, mean, sqrt(variance), cycles_per_block);
+  fflush(stdout);
+}
+
+// Calls fn(size, corner) for all block sizes and parameter corners.
+template<typename F>
+void ForEachCase(F&& fn) {
+  for (size_t s = 0; s < sizeof(block_sizes) / sizeof(block_sizes[0]); ++s) {
+    if (block_sizes[s] > kMaxBlockSize) {
+      continue;
+    }
+    for (size_t c = 0; c < sizeof(corners) / sizeof(corners[0]); ++c) {
+      fn(block_sizes[s], corners[c]);
+    }
+  }
+}
+
+template<typename T>
+void BenchmarkEngine(const char* name) {
+  ForEachCase([name](size_t size, const Corner& corner) {
+    BufferAllocator allocator(ram_block, sizeof(ram_block));
+    T* engine = new T;
+    InitEngine(*engine, &allocator);
+    engine->LoadUserData(NULL);
+    engine->Reset();
+    
+    EngineParameters p;
+    p.harmonics = corner.harmonics;
+    p.timbre = corner.timbre;
+    p.morph = corner.morph;
+    p.note = corner.note;
+    p.accent = 0.8f;
+    
+    float out[kMaxBlockSize];
+    float aux[kMaxBlockSize];
+    Measure(name, corner.name, size, [&](size_t size, size_t block) {
+      int phase = block % kTriggerPeriod;
+      p.trigger = phase == 0
+          ? TRIGGER_RISING_EDGE | TRIGGER_HIGH
+          : (phase < kTriggerPeriod / 2 ? TRIGGER_HIGH : TRIGGER_LOW);
+      bool already_enveloped = false;
+      engine->Render(p, out, aux, size, &already_enveloped);
+    });
+    delete engine;
+  });
+}
+
+// The six-op engine at each polyphony, with a new note (and patch) every few
+// blocks so that all voices are sounding. Used to refit SixOpCostModel.
+void BenchmarkSixOpPolyphony() {
+  const size_t kNoteInterval = 4;  // In blocks.
+  for (int polyphony = 1; polyphony <= kMaxSixOpVoices; ++polyphony) {
+    char name[32];
+    snprintf(name, sizeof(name), "SixOpEngine/%d", polyphony);
+    ForEachCase([&](size_t size, const Corner& corner) {
+      BufferAllocator allocator(ram_block, sizeof(ram_block));
+      SixOpEngine* engine = new SixOpEngine;
+      engine->Init(&allocator);
+      engine->set_polyphony(polyphony);
+      
+      EngineParameters p;
+      p.timbre = corner.timbre;
+      p.morph = corner.morph;
+      p.accent = 0.8f;
+      
+      float out[kMaxBlockSize];
+      float aux[kMaxBlockSize];
+      Measure(name, corner.name, size, [&](size_t size, size_t block) {
+        const size_t note = block / kNoteInterval;
+        p.harmonics = float((note * 7) % kNumPatchesPerBank);
+        p.note = corner.note + float(note % 12);
+        p.trigger = block % kNoteInterval == 0
+            ? TRIGGER_RISING_EDGE | TRIGGER_HIGH
+            : TRIGGER_HIGH;
+        bool already_enveloped = false;
+        engine->Render(p, out, aux, size, &already_enveloped);
+      });
+      delete engine;
+    });
+  }
+}
+
+void BenchmarkOscillator() {
+  ForEachCase([](size_t size, const Corner& corner) {
+    Oscillator osc;
+    float out[kMaxBlockSize];
+    float f = NoteToInc(corner.note);
+    Measure("Oscillator", corner.name, size, [&](size_t size, size_t block) {
+      osc.Render<OSCILLATOR_SHAPE_SQUARE>(f, corner.timbre, out, size);
+    });
+  });
+}
+
+void BenchmarkWavetableOscillator() {
+  const int16_t* waves[15];
+  for (int i = 0; i < 15; ++i) {
+    waves[i] = &wav_integrated_waves[i * 132];
+  }
+  ForEachCase([&waves](size_t size, const Corner& corner) {
+    WavetableOscillator<128, 15> osc;
+    osc.Init();
+    float out[kMaxBlockSize];
+    float f = NoteToInc(corner.note);
+    Measure("WavetableOscillator", corner.name, size, [&](
+        size_t size, size_t block) {
+      osc.Render(f, 1.0f, corner.morph, waves, out, size);
+    });
+  });
+}
+
+void BenchmarkHarmonicOscillator() {
+  ForEachCase([](size_t size, const Corner& corner) {
+    HarmonicOscillator<12> osc;
+    osc.Init();
+    float amplitudes[12];
+    for (int i = 0; i < 12; ++i) {
+      amplitudes[i] = corner.harmonics / float(i + 1);
+    }
+    float out[kMaxBlockSize];
+    float f = NoteToInc(corner.note);
+    Measure("HarmonicOscillator", corner.name, size, [&](
+        size_t size, size_t block) {
+      fill(&out[0], &out[size], 0.0f);
+      osc.Render<1>(f, amplitudes, out, size);
+    });
+  });
+}
+
+void BenchmarkFMVoice() {
+  fm::Algorithms<6>* algorithms = new fm::Algorithms<6>;
+  fm::Patch* patch = new fm::Patch;
+  patch->Unpack(fm_patches_table[0]);
+  fm::Voice<6>::PatchSetup* setup = new fm::Voice<6>::PatchSetup(
+      fm::Voice<6>::PatchSetup::Compute(*patch));
+
+  ForEachCase([&](size_t size, const Corner& corner) {
+    fm::Voice<6>* voice = new fm::Voice<6>;
+    voice->Init(algorithms);
+    voice->SetPatch(patch, setup);
+    
+    fm::Voice<6>::Parameters p;
+    p.note = corner.note;
+    p.brightness = corner.timbre;
+    p.envelope_control = corner.morph;
+    float out[kMaxBlockSize];
+    Measure("fm::Voice<6>", corner.name, size, [&](size_t size, size_t block) {
+      p.gate = (block % kTriggerPeriod) < kTriggerPeriod / 2;
+      fill(&out[0], &out[size], 0.0f);
+      voice->Render(p, out, size);
+    });
+    delete voice;
+  });
+  delete setup;
+  delete patch;
+  delete algorithms;
+}
+
+// simd::kNumLanes voices with the same patch, rendered in parallel. The time
+// per sample covers all the voices.
+void BenchmarkFMVoiceLanes() {
+  const size_t lanes = simd::kNumLanes;
+  fm::Algorithms<6>* algorithms = new fm::Algorithms<6>;
+  fm::Patch* patch = new fm::Patch;
+  patch->Unpack(fm_patches_table[0]);
+  fm::Voice<6>::PatchSetup* setup = new fm::Voice<6>::PatchSetup(
+      fm::Voice<6>::PatchSetup::Compute(*patch));
+  
+  char name[32];
+  snprintf(name, sizeof(name), "fm::Voice<6>x%zu", lanes);
+
+  ForEachCase([&](size_t size, const Corner& corner) {
+    fm::Voice<6>* voices = new fm::Voice<6>[lanes];
+    fm::Voice<6>* voice_ptr[lanes];
+    fm::Voice<6>::Parameters p[lanes];
+    float* out = new float[lanes * kMaxBlockSize];
+    float* out_ptr[lanes];
+    float* temp = new float[lanes * kMaxBlockSize];
+    for (size_t l = 0; l < lanes; ++l) {
+      voices[l].Init(algorithms);
+      voices[l].SetPatch(patch, setup);
+      voice_ptr[l] = &voices[l];
+      out_ptr[l] = &out[l * kMaxBlockSize];
+      p[l].note = corner.note + float(l);
+      p[l].brightness = corner.timbre;
+      p[l].envelope_control = corner.morph;
+    }
+    Measure(name, corner.name, size, [&](size_t size, size_t block) {
+      for (size_t l = 0; l < lanes; ++l) {
+        p[l].gate = (block % kTriggerPeriod) < kTriggerPeriod / 2;
+      }
+      fill(&out[0], &out[lanes * kMaxBlockSize], 0.0f);
+      fm::Voice<6>::RenderLanes(voice_ptr, p, temp, out_ptr, size);
+    });
+    delete[] temp;
+    delete[] out;
+    delete[] voices;
+  });
+  delete setup;
+  delete patch;
+  delete algorithms;
+}
+
+// The LFOs of 8 voices on different patches (one per waveform, with the
+// rate set by the corner): stepped one by one, and as a bank.
+void BenchmarkFMLfos() {
+  const int num_lfos = 8;
+  ForEachCase([&](size_t size, const Corner& corner) {
+    fm::Patch* patches = new fm::Patch[num_lfos];
+    for (int i = 0; i < num_lfos; ++i) {
+      fm::Patch::ModulationParameters& m = patches[i].modulations;
+      m = fm::Patch::ModulationParameters{};
+      m.rate = uint8_t(corner.harmonics * 90.0f) + i;
+      m.waveform = uint8_t(i % 6);
+      m.pitch_mod_depth = m.amp_mod_depth = 50;
+    }
+
+    fm::Lfo* lfos = new fm::Lfo[num_lfos];
+    for (int i = 0; i < num_lfos; ++i) {
+      lfos[i].Set(patches[i].modulations);
+    }
+    float modulations[2 * num_lfos];
+    Measure("fm::Lfo", corner.name, size, [&](size_t size, size_t block) {
+      for (int i = 0; i < num_lfos; ++i) {
+        lfos[i].Step(float(size));
+        modulations[2 * i] = lfos[i].pitch_mod();
+        modulations[2 * i + 1] = lfos[i].amp_mod();
+      }
+    });
+    delete[] lfos;
+
+    fm::LfoBank<num_lfos>* bank = new fm::LfoBank<num_lfos>;
+    bank->Init(0);
+    for (int i = 0; i < num_lfos; ++i) {
+      bank->Acquire(&patches[i]);
+    }
+    Measure("fm::LfoBank", corner.name, size, [&](size_t size, size_t block) {
+      bank->Step(float(size));
+      for (int i = 0; i < num_lfos; ++i) {
+        modulations[2 * i] = bank->pitch_mod(i);
+        modulations[2 * i + 1] = bank->amp_mod(i);
+      }
+    });
+    delete bank;
+    delete[] patches;
+  });
+}
+
+// A modulator driving a carrier, with an index set by TIMBRE: the lookup table
+// and the polynomial sine, in scalar code and in SIMD lanes.
+template<typename Sine>
+void BenchmarkSinePM(const char* name, Sine sine) {
+  ForEachCase([&](size_t size, const Corner& corner) {
+    const uint32_t f = static_cast<uint32_t>(
+        NoteToInc(corner.note) * 4294967296.0f);
+    const float index = corner.timbre * 8.0f;
+    uint32_t modulator_phase = 0;
+    uint32_t carrier_phase = 0;
+    float out[kMaxBlockSize];
+    Measure(name, corner.name, size, [&](size_t size, size_t block) {
+      for (size_t i = 0; i < size; ++i) {
+        modulator_phase += f * 3;
+        carrier_phase += f;
+        const float modulator = sine(modulator_phase, 0.0f);
+        out[i] = sine(carrier_phase, modulator * index);
+      }
+    });
+  });
+}
+
+template<typename Sine>
+void BenchmarkSinePMLanes(const char* name, Sine sine) {
+  using namespace simd;
+  ForEachCase([&](size_t size, const Corner& corner) {
+    uint32_t f[kNumLanes];
+    for (size_t l = 0; l < kNumLanes; ++l) {
+      f[l] = static_cast<uint32_t>(
+          NoteToInc(corner.note + float(l)) * 4294967296.0f);
+    }
+    const Int frequency = Load(f);
+    const Float index = Set(corner.timbre * 8.0f);
+    Int modulator_phase = Set(uint32_t(0));
+    Int carrier_phase = Set(uint32_t(0));
+    float out[kMaxBlockSize * kNumLanes];
+    Measure(name, corner.name, size, [&](size_t size, size_t block) {
+      for (size_t i = 0; i < size; ++i) {
+        modulator_phase = Add(modulator_phase, Add(frequency,
+            ShiftLeft<1>(frequency)));
+        carrier_phase = Add(carrier_phase, frequency);
+        const Float modulator = sine(modulator_phase, Set(0.0f));
+        Store(&out[i * kNumLanes], sine(carrier_phase, Mul(modulator, index)));
+      }
+    });
+  });
+}
+
+// The resonator with its mode count capped at a few values. Above the cap,
+// the modes culled near Nyquist already reduce the cost for the high notes.
+void BenchmarkResonator() {
+  const int max_num_modes[] = { kMaxNumModes, 16, 8 };
+  for (int m : max_num_modes) {
+    char name[32];
+    snprintf(name, sizeof(name), "Resonator/%d", m);
+    ForEachCase([&](size_t size, const Corner& corner) {
+      Resonator* resonator = new Resonator;
+      resonator->set_max_num_modes(m);
+      float in[kMaxBlockSize];
+      float out[kMaxBlockSize];
+      float f0 = NoteToInc(corner.note);
+      Measure(name, corner.name, size, [&](size_t size, size_t block) {
+        fill(&in[0], &in[size], 0.0f);
+        in[0] = block % kTriggerPeriod == 0 ? 1.0f : 0.0f;
+        resonator->Process(
+            f0, corner.harmonics, corner.timbre, corner.morph, in, out, size);
+      });
+      delete resonator;
+    });
+  }
+}
+
+void BenchmarkString() {
+  ForEachCase([](size_t size, const Corner& corner) {
+    String* string = new String;
+    string->Reset();
+    float in[kMaxBlockSize];
+    float out[kMaxBlockSize];
+    float f0 = NoteToInc(corner.note);
+    float non_linearity = corner.harmonics * 2.0f - 1.0f;
+    Measure("String", corner.name, size, [&](size_t size, size_t block) {
+      fill(&in[0], &in[size], 0.0f);
+      in[0] = block % kTriggerPeriod == 0 ? 1.0f : 0.0f;
+      fill(&out[0], &out[size], 0.0f);
+      string->Process(
+          f0, non_linearity, corner.timbre, corner.morph, in, out, size);
+    });
+    delete string;
+  });
+}
+
+// A strum on six strings, one string plucked per block: with a StringBank,
+// with six StringVoices as six StringEngines would render it, and with six
+// bare Strings (without their excitation).
+void BenchmarkStringBank() {
+  const size_t kNumStrings = 6;
+  const float chord[kNumStrings] = { 0.0f, 5.0f, 10.0f, 15.0f, 19.0f, 24.0f };
+  ForEachCase([&](size_t size, const Corner& corner) {
+    float f0[kNumStrings];
+    for (size_t i = 0; i < kNumStrings; ++i) {
+      f0[i] = NoteToInc(corner.note + chord[i]);
+    }
+    float in[kMaxBlockSize];
+    float out[kMaxBlockSize];
+    float aux[kMaxBlockSize];
+    fill(&in[0], &in[size], 0.0f);
+
+    vector<char> ram(StringBank<kNumStrings>::kSharedRamSize);
+    BufferAllocator allocator(ram.data(), ram.size());
+    StringBank<kNumStrings>* bank = new StringBank<kNumStrings>;
+    bank->Init(&allocator);
+    for (size_t i = 0; i < kNumStrings; ++i) {
+      bank->set_f0(i, f0[i]);
+    }
+    float non_linearity = corner.harmonics * 2.0f - 1.0f;
+    Measure("StringBank/6", corner.name, size, [&](size_t size, size_t block) {
+      const size_t string = block % kTriggerPeriod;
+      if (string < kNumStrings) {
+        bank->Pluck(string, 0.8f);
+      }
+      fill(&out[0], &out[size], 0.0f);
+      bank->Process(
+          non_linearity, corner.timbre, corner.morph, in, out, size);
+    });
+    delete bank;
+
+    StringVoice* voices = new StringVoice[kNumStrings];
+    for (size_t i = 0; i < kNumStrings; ++i) {
+      voices[i].Reset();
+    }
+    Measure("StringVoice/6", corner.name, size, [&](size_t size, size_t block) {
+      fill(&out[0], &out[size], 0.0f);
+      fill(&aux[0], &aux[size], 0.0f);
+      for (size_t i = 0; i < kNumStrings; ++i) {
+        voices[i].Render(
+            false, block % kTriggerPeriod == i, 0.8f, f0[i],
+            corner.harmonics, corner.timbre, corner.morph, in, out, aux, size);
+      }
+    });
+    delete[] voices;
+
+    String* strings = new String[kNumStrings];
+    for (size_t i = 0; i < kNumStrings; ++i) {
+      strings[i].Reset();
+    }
+    Measure("String/6", corner.name, size, [&](size_t size, size_t block) {
+      fill(&out[0], &out[size], 0.0f);
+      for (size_t i = 0; i < kNumStrings; ++i) {
+        strings[i].Process(
+            f0[i], non_linearity, corner.timbre, corner.morph, in, out, size);
+      }
+    });
+    delete[] strings;
+  });
+}
+
+int main(int argc, char** argv) {
+  _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+  printf("name,corner,block_size,ns_per_sample,ns_per_sample_stddev,"
+         "cycles_per_block\n");
+  
+  BenchmarkEngine<VirtualAnalogVCFEngine>("VirtualAnalogVCFEngine");
+  BenchmarkEngine<PhaseDistortionEngine>("PhaseDistortionEngine");
+  BenchmarkEngine<SixOpEngine>("SixOpEngine");
+  BenchmarkEngine<FourOpEngine>("FourOpEngine");
+  BenchmarkEngine<StrumEngine>("StrumEngine");
+  BenchmarkEngine<WaveTerrainEngine>("WaveTerrainEngine");
+  BenchmarkEngine<StringMachineEngine>("StringMachineEngine");
+  BenchmarkEngine<ChiptuneEngine>("ChiptuneEngine");
+  BenchmarkEngine<VirtualAnalogEngine>("VirtualAnalogEngine");
+  BenchmarkEngine<WaveshapingEngine>("WaveshapingEngine");
+  BenchmarkEngine<FMEngine>("FMEngine");
+  BenchmarkEngine<GrainEngine>("GrainEngine");
+  BenchmarkEngine<AdditiveEngine>("AdditiveEngine");
+  BenchmarkEngine<WavetableEngine>("WavetableEngine");
+  BenchmarkEngine<ChordEngine>("ChordEngine");
+  BenchmarkEngine<NaiveSpeechEngine>("NaiveSpeechEngine");
+  BenchmarkEngine<SwarmEngine>("SwarmEngine");
+  BenchmarkEngine<NoiseEngine>("NoiseEngine");
+  BenchmarkEngine<ParticleEngine>("ParticleEngine");
+  BenchmarkEngine<StringEngine>("StringEngine");
+  BenchmarkEngine<ModalEngine>("ModalEngine");
+  BenchmarkEngine<BassDrumEngine>("BassDrumEngine");
+  BenchmarkEngine<SnareDrumEngine>("SnareDrumEngine");
+  BenchmarkEngine<HiHatEngine>("HiHatEngine");
+  BenchmarkSixOpPolyphony();
+  
+  BenchmarkOscillator();
+  BenchmarkWavetableOscillator();
+  BenchmarkHarmonicOscillator();
+  BenchmarkFMVoice();
+  BenchmarkFMVoiceLanes();
+  BenchmarkFMLfos();
+  BenchmarkSinePM("SinePM", [](uint32_t phase, float pm) {
+    return SinePM(phase, pm);
+  });
+  BenchmarkSinePM("SinePMPoly", [](uint32_t phase, float pm) {
+    return SinePMPoly(phase, pm);
+  });
+  BenchmarkSinePMLanes("SinePM/lanes", [](simd::Int phase, simd::Float pm) {
+    return SinePM(phase, pm);
+  });
+  BenchmarkSinePMLanes("SinePMPoly/lanes", [](
+      simd::Int phase, simd::Float pm) {
+    return SinePMPoly(phase, pm);
+  });
+  BenchmarkResonator();
+  BenchmarkString();
+  BenchmarkStringBank();
+}
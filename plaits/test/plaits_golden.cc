@@ -0,0 +1,312 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Golden-output regression test.
+//
+// Renders a fixed parameter sweep through every engine, with the random
+// generator seeded identically for each engine, and compares the result with
+// the references stored in golden.txt. Each reference holds a hash of the
+// raw output (for bit-exact comparisons) and a coarse spectrogram: the energy
+// in kNumBands log-spaced bands for each frame of kFrameSize samples (for
+// comparisons with a tolerance, when a change is not expected to be
+// bit-exact, eg. SIMD or new lookup tables).
+//
+// usage: plaits_golden [-update] [-exact] [-tolerance dB] [-r references]
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <xmmintrin.h>
+
+#include "core/random.hh"
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/dsp/voice.h"
+
+using namespace std;
+using namespace stmlib;
+using namespace plaits;
+
+const size_t kDuration = 2 * static_cast<size_t>(kSampleRate);
+const size_t kTriggerPeriod = static_cast<size_t>(kSampleRate) / 4;
+const size_t kFrameSize = 4096;
+const size_t kNumFrames = kDuration / kFrameSize;
+const int kNumBands = 11;  // Octaves, from 12 Hz to 24 kHz.
+const float kSilence = -120.0f;
+
+struct Golden {
+  uint64_t hash;
+  vector<float> bands;  // kNumFrames * kNumBands, for out then aux.
+};
+
+// Same as WavWriter::triangle, but on a sample counter.
+inline float Triangle(size_t sample, float period) {
+  float phase = static_cast<float>(sample) / (period * kSampleRate);
+  phase -= static_cast<float>(static_cast<int>(phase));
+  return phase < 0.5f ? 2.0f * phase : 2.0f - 2.0f * phase;
+}
+
+inline uint64_t Hash(uint64_t hash, const float* data, size_t size) {
+  // FNV-1a on the bit patterns of the samples.
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size * sizeof(float); ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+void FFT(complex<float>* x, size_t n) {
+  for (size_t i = 1, j = 0; i < n; ++i) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      swap(x[i], x[j]);
+    }
+  }
+  for (size_t length = 2; length <= n; length <<= 1) {
+    float angle = -2.0f * static_cast<float>(M_PI) / length;
+    complex<float> w_length(cosf(angle), sinf(angle));
+    for (size_t i = 0; i < n; i += length) {
+      complex<float> w(1.0f, 0.0f);
+      for (size_t j = 0; j < length / 2; ++j) {
+        complex<float> u = x[i + j];
+        complex<float> v = x[i + j + length / 2] * w;
+        x[i + j] = u + v;
+        x[i + j + length / 2] = u - v;
+        w *= w_length;
+      }
+    }
+  }
+}
+
+// Appends the band energies (in dB) of each frame of the signal.
+void Analyze(const vector<float>& signal, vector<float>* bands) {
+  vector<complex<float> > x(kFrameSize);
+  for (size_t frame = 0; frame < kNumFrames; ++frame) {
+    for (size_t i = 0; i < kFrameSize; ++i) {
+      float window = 0.5f - 0.5f * cosf(2.0f * M_PI * i / kFrameSize);
+      x[i] = signal[frame * kFrameSize + i] * window;
+    }
+    FFT(&x[0], kFrameSize);
+    
+    // Octave bands, from the top of the spectrum.
+    size_t end = kFrameSize / 2;
+    float energy[kNumBands];
+    for (int band = kNumBands - 1; band >= 0; --band) {
+      size_t start = band == 0 ? 1 : max<size_t>(end / 2, 1);
+      energy[band] = 0.0f;
+      for (size_t i = start; i < end; ++i) {
+        energy[band] += norm(x[i]);
+      }
+      end = start;
+    }
+    for (int band = 0; band < kNumBands; ++band) {
+      float db = 10.0f * log10f(energy[band] + 1e-12f);
+      bands->push_back(max(db, kSilence));
+    }
+  }
+}
+
+template<typename T>
+Golden Render(int seed) {
+  ToySynth::Random::seed(seed);
+  vector<char> ram(Voice::kSharedRamSize);
+  BufferAllocator allocator(ram.data(), ram.size());
+  T* engine = new T;
+  InitEngine(*engine, &allocator);
+  engine->LoadUserData(NULL);
+  engine->Reset();
+  
+  vector<float> out(kDuration);
+  vector<float> aux(kDuration);
+  EngineParameters p;
+  p.accent = 0.8f;
+  for (size_t i = 0; i < kDuration; i += kMaxBlockSize) {
+    size_t phase = i % kTriggerPeriod;
+    p.trigger = phase < kMaxBlockSize
+        ? TRIGGER_RISING_EDGE | TRIGGER_HIGH
+        : (phase < kTriggerPeriod / 2 ? TRIGGER_HIGH : TRIGGER_LOW);
+    p.note = 36.0f + 3.0f * static_cast<float>((i / kTriggerPeriod) % 12);
+    p.harmonics = Triangle(i, 0.7f);
+    p.timbre = Triangle(i, 1.1f);
+    p.morph = Triangle(i, 1.9f);
+    bool already_enveloped = false;
+    size_t size = min(kMaxBlockSize, kDuration - i);
+    engine->Render(p, &out[i], &aux[i], size, &already_enveloped);
+  }
+  delete engine;
+  
+  Golden golden;
+  golden.hash = Hash(Hash(0xcbf29ce484222325ULL, &out[0], kDuration),
+                     &aux[0], kDuration);
+  Analyze(out, &golden.bands);
+  Analyze(aux, &golden.bands);
+  return golden;
+}
+
+bool Load(const char* file_name, map<string, Golden>* references) {
+  FILE* fp = fopen(file_name, "r");
+  if (!fp) {
+    return false;
+  }
+  char name[64];
+  unsigned long long hash;
+  while (fscanf(fp, "%63s %llx", name, &hash) == 2) {
+    Golden& g = (*references)[name];
+    g.hash = hash;
+    g.bands.resize(kNumFrames * kNumBands * 2);
+    for (size_t i = 0; i < g.bands.size(); ++i) {
+      if (fscanf(fp, "%f", &g.bands[i]) != 1) {
+        fclose(fp);
+        return false;
+      }
+    }
+  }
+  fclose(fp);
+  return true;
+}
+
+void Save(const char* file_name, const map<string, Golden>& references) {
+  FILE* fp = fopen(file_name, "w");
+  for (map<string, Golden>::const_iterator it = references.begin();
+       it != references.end(); ++it) {
+    fprintf(fp, "%s %016llx\n", it->first.c_str(),
+        static_cast<unsigned long long>(it->second.hash));
+    for (size_t i = 0; i < it->second.bands.size(); ++i) {
+      fprintf(fp, "%.1f%c", it->second.bands[i],
+          (i + 1) % kNumBands == 0 ? '\n' : ' ');
+    }
+  }
+  fclose(fp);
+}
+
+struct Options {
+  bool update;
+  bool exact;
+  float tolerance;
+};
+
+// Largest difference between the band energies of a frame, in dB.
+float Distance(const Golden& a, const Golden& b) {
+  float distance = 0.0f;
+  for (size_t i = 0; i < a.bands.size(); ++i) {
+    distance = max(distance, fabsf(a.bands[i] - b.bands[i]));
+  }
+  return distance;
+}
+
+template<typename T>
+bool Check(
+    const char* name,
+    const Options& options,
+    map<string, Golden>* references) {
+  static int seed = 0;
+  Golden golden = Render<T>(++seed);
+  
+  if (options.update) {
+    (*references)[name] = golden;
+    return true;
+  }
+  
+  map<string, Golden>::const_iterator reference = references->find(name);
+  if (reference == references->end()) {
+    printf("%-24s MISSING\n", name);
+    return false;
+  }
+  
+  bool identical = golden.hash == reference->second.hash;
+  float distance = Distance(golden, reference->second);
+  bool success = identical || (!options.exact && distance <= options.tolerance);
+  printf("%-24s %s (%s, %.2f dB)\n",
+      name,
+      success ? "OK" : "FAIL",
+      identical ? "bit-exact" : "different",
+      distance);
+  return success;
+}
+
+int main(int argc, char** argv) {
+  _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+  
+  Options options;
+  options.update = false;
+  options.exact = false;
+  options.tolerance = 1.0f;
+  const char* file_name = "plaits/test/golden.txt";
+  
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-update")) {
+      options.update = true;
+    } else if (!strcmp(argv[i], "-exact")) {
+      options.exact = true;
+    } else if (!strcmp(argv[i], "-tolerance") && i + 1 < argc) {
+      options.tolerance = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+      file_name = argv[++i];
+    } else {
+      fprintf(stderr, "usage: plaits_golden [-update] [-exact] "
+          "[-tolerance dB] [-r references]\n");
+      return 1;
+    }
+  }
+  
+  map<string, Golden> references;
+  if (!options.update && !Load(file_name, &references)) {
+    fprintf(stderr, "%s: cannot read references, run with -update\n",
+        file_name);
+    return 1;
+  }
+  
+  int num_failures = 0;
+  num_failures += !Check<VirtualAnalogVCFEngine>("VirtualAnalogVCFEngine", options, &references);
+  num_failures += !Check<PhaseDistortionEngine>("PhaseDistortionEngine", options, &references);
+  num_failures += !Check<SixOpEngine>("SixOpEngine", options, &references);
+  num_failures += !Check<WaveTerrainEngine>("WaveTerrainEngine", options, &references);
+  num_failures += !Check<StringMachineEngine>("StringMachineEngine", options, &references);
+  num_failures += !Check<ChiptuneEngine>("ChiptuneEngine", options, &references);
+  num_failures += !Check<VirtualAnalogEngine>("VirtualAnalogEngine", options, &references);
+  num_failures += !Check<WaveshapingEngine>("WaveshapingEngine", options, &references);
+  num_failures += !Check<FMEngine>("FMEngine", options, &references);
+  num_failures += !Check<GrainEngine>("GrainEngine", options, &references);
+  num_failures += !Check<AdditiveEngine>("AdditiveEngine", options, &references);
+  num_failures += !Check<WavetableEngine>("WavetableEngine", options, &references);
+  num_failures += !Check<ChordEngine>("ChordEngine", options, &references);
+  num_failures += !Check<NaiveSpeechEngine>("NaiveSpeechEngine", options, &references);
+  num_failures += !Check<SwarmEngine>("SwarmEngine", options, &references);
+  num_failures += !Check<NoiseEngine>("NoiseEngine", options, &references);
+  num_failures += !Check<ParticleEngine>("ParticleEngine", options, &references);
+  num_failures += !Check<StringEngine>("StringEngine", options, &references);
+  num_failures += !Check<ModalEngine>("ModalEngine", options, &references);
+  num_failures += !Check<BassDrumEngine>("BassDrumEngine", options, &references);
+  num_failures += !Check<SnareDrumEngine>("SnareDrumEngine", options, &references);
+  num_failures += !Check<HiHatEngine>("HiHatEngine", options, &references);
+  
+  if (options.update) {
+    Save(file_name, references);
+    printf("%zu references written to %s\n", references.size(), file_name);
+  } else {
+    printf("%d failures\n", num_failures);
+  }
+  return num_failures ? 1 : 0;
+}
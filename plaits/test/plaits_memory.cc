@@ -0,0 +1,122 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Memory footprint report for the engines and the voice.
+//
+// For each engine: the size of its object (state and embedded buffers), the
+// shared RAM it declares (kSharedRamSize), and the shared RAM it actually takes
+// from the allocator in Init(). Exits with an error if an engine uses more or
+// less shared RAM than it declares: Voice::kSharedRamSize is sized from the
+// declarations, which are derived from the engines' EngineBuffers.
+//
+// Build with -DPLAITS_SHARED_ENGINE_RAM to see the figures with the engines'
+// buffers moved to the shared RAM, and what their overlap saves. With the
+// current engines it saves little: the particle engine's 16 kB buffer sets the
+// size of the shared RAM, and the other buffers only add up to about 3 kB.
+// Embedded buffers are the default, so that every engine can be crossfaded and
+// prepared in the background.
+
+#include <cstdio>
+#include <vector>
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/dsp/engine2/four_op_engine.h"
+#include "plaits/dsp/engine2/strum_engine.h"
+#include "plaits/dsp/voice.h"
+#include "plaits/dsp/voice_pool.h"
+
+using namespace std;
+using namespace stmlib;
+using namespace plaits;
+
+const size_t kRamSize = 64 * 1024;
+
+int num_errors = 0;
+
+template<typename T>
+void ReportEngine(const char* name) {
+  vector<char> ram(kRamSize);
+  BufferAllocator allocator(&ram[0], kRamSize);
+  T* engine = new T;
+  InitEngine(*engine, &allocator);
+  const size_t used = kRamSize - allocator.free();
+  const size_t declared = kEngineSharedRamSize<T>;
+  delete engine;
+  
+  printf("%-24s %8zu %8zu %8zu%s\n",
+      name, sizeof(T), declared, used,
+      used > declared ? "  ERROR: undeclared shared RAM" :
+      used < declared ? "  ERROR: unused shared RAM" : "");
+  num_errors += used != declared;
+}
+
+int main(int argc, char** argv) {
+  printf("block size: %zu, shared engine RAM: %s\n\n",
+      kMaxBlockSize, kSharedEngineRam ? "on" : "off");
+  printf("%-24s %8s %8s %8s\n", "engine", "state", "declared", "used");
+  
+  ReportEngine<VirtualAnalogVCFEngine>("VirtualAnalogVCFEngine");
+  ReportEngine<PhaseDistortionEngine>("PhaseDistortionEngine");
+  ReportEngine<SixOpEngine>("SixOpEngine");
+  ReportEngine<FourOpEngine>("FourOpEngine");
+  ReportEngine<StrumEngine>("StrumEngine");
+  ReportEngine<WaveTerrainEngine>("WaveTerrainEngine");
+  ReportEngine<StringMachineEngine>("StringMachineEngine");
+  ReportEngine<ChiptuneEngine>("ChiptuneEngine");
+  ReportEngine<VirtualAnalogEngine>("VirtualAnalogEngine");
+  ReportEngine<WaveshapingEngine>("WaveshapingEngine");
+  ReportEngine<FMEngine>("FMEngine");
+  ReportEngine<GrainEngine>("GrainEngine");
+  ReportEngine<AdditiveEngine>("AdditiveEngine");
+  ReportEngine<WavetableEngine>("WavetableEngine");
+  ReportEngine<ChordEngine>("ChordEngine");
+  ReportEngine<NaiveSpeechEngine>("NaiveSpeechEngine");
+  ReportEngine<SwarmEngine>("SwarmEngine");
+  ReportEngine<NoiseEngine>("NoiseEngine");
+  ReportEngine<ParticleEngine>("ParticleEngine");
+  ReportEngine<StringEngine>("StringEngine");
+  ReportEngine<ModalEngine>("ModalEngine");
+  ReportEngine<BassDrumEngine>("BassDrumEngine");
+  ReportEngine<SnareDrumEngine>("SnareDrumEngine");
+  ReportEngine<HiHatEngine>("HiHatEngine");
+  
+  const size_t voice_ram = sizeof(Voice) + Voice::kSharedRamSize;
+  printf("\n");
+  printf("largest engine           %8zu (budget %d)\n",
+      VoiceEngineRegistry::kMaxStateSize, PLAITS_ENGINE_STATE_BUDGET);
+  printf("all engines              %8zu\n",
+      VoiceEngineRegistry::kTotalStateSize);
+  printf("voice                    %8zu\n", sizeof(Voice));
+  printf("voice shared RAM         %8zu\n", Voice::kSharedRamSize);
+  printf("voice total              %8zu (budget %d)\n",
+      voice_ram, PLAITS_VOICE_RAM_BUDGET);
+  printf("8-voice pool             %8zu\n",
+      sizeof(VoicePool<8>) + VoicePool<8>::kRamSize);
+  if (kSharedEngineRam) {
+    // Without the shared RAM, each engine would embed its own buffers.
+    const size_t saving = VoiceEngineRegistry::kTotalSharedRamSize -
+        VoiceEngineRegistry::kMaxSharedRamSize;
+    const size_t percent = saving * 100 / (voice_ram + saving);
+    printf("shared RAM saving        %8zu (%zu%% of the voice)\n",
+        saving, percent);
+    if (percent < 10) {
+      printf("\nThe shared RAM buys less than 10%% of the voice's memory, and "
+          "prevents\nthe engines using it from being crossfaded or prepared "
+          "in the background.\n");
+    }
+  }
+  
+  return num_errors ? 1 : 0;
+}
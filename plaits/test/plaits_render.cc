@@ -0,0 +1,191 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Offline renderer: renders text scores (see score.h) through a Voice to WAV
+// or raw float files, and reports the real-time factor of each render.
+//
+// usage: plaits_render [-j threads] [-b block_size] [-raw] score...
+//
+// Each score is written next to its source file, with a .wav or .raw
+// extension (raw files contain interleaved out/aux float32 samples).
+// Scores are distributed across threads; each render owns its Voice and RAM
+// block, so renders never share mutable state.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <xmmintrin.h>
+
+#include "core/random.hh"
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/dsp/voice.h"
+#include "plaits/test/score.h"
+
+#include "stmlib/test/wav_writer.h"
+
+using namespace std;
+using namespace stmlib;
+using namespace plaits;
+
+const size_t kRamSize = Voice::kSharedRamSize;
+
+struct RenderJob {
+  const char* score_file_name;
+  bool raw;
+  size_t block_size;
+};
+
+string OutputFileName(const char* score_file_name, bool raw) {
+  string name(score_file_name);
+  size_t dot = name.find_last_of('.');
+  size_t slash = name.find_last_of('/');
+  if (dot != string::npos && (slash == string::npos || dot > slash)) {
+    name.erase(dot);
+  }
+  return name + (raw ? ".raw" : ".wav");
+}
+
+bool Render(const RenderJob& job, double* real_time_factor) {
+  Score score;
+  if (!score.Load(job.score_file_name)) {
+    return false;
+  }
+  
+  // The random generator state is per-thread: seeding it makes each render
+  // reproducible whatever the other threads are doing.
+  ToySynth::Random::seed(1);
+  vector<char> ram(kRamSize);
+  BufferAllocator allocator(ram.data(), kRamSize);
+  Voice* voice = new Voice;
+  voice->Init(&allocator);
+  
+  string output = OutputFileName(job.score_file_name, job.raw);
+  double duration = static_cast<double>(score.duration()) / kSampleRate;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  bool opened = true;
+  bool rendered = true;
+  
+  if (job.raw) {
+    FILE* fp = fopen(output.c_str(), "wb");
+    if (fp) {
+      rendered = score.Render(voice, job.block_size, [fp](
+          const Voice::Frame* frames, size_t size) {
+        float buffer[kMaxBlockSize * 2];
+        for (size_t i = 0; i < size; ++i) {
+          buffer[2 * i] = static_cast<float>(frames[i].out) / 32768.0f;
+          buffer[2 * i + 1] = static_cast<float>(frames[i].aux) / 32768.0f;
+        }
+        fwrite(buffer, sizeof(float), size * 2, fp);
+      });
+      fclose(fp);
+    } else {
+      opened = false;
+    }
+  } else {
+    WavWriter wav_writer(2, kSampleRate, max(duration, 1.0));
+    if (wav_writer.Open(output.c_str())) {
+      rendered = score.Render(voice, job.block_size, [&wav_writer](
+          const Voice::Frame* frames, size_t size) {
+        wav_writer.WriteFrames(const_cast<short*>(&frames[0].out), size);
+      });
+    } else {
+      opened = false;
+    }
+  }
+  
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  *real_time_factor = elapsed.count() > 0.0 ? duration / elapsed.count() : 0.0;
+  delete voice;
+  
+  if (!opened) {
+    fprintf(stderr, "%s: cannot write file\n", output.c_str());
+  } else if (!rendered) {
+    fprintf(stderr, "%s: more than %zu events at the same time\n",
+        job.score_file_name, kMaxVoiceEvents);
+  }
+  return opened && rendered;
+}
+
+void Usage() {
+  fprintf(stderr,
+      "usage: plaits_render [-j threads] [-b block_size] [-raw] score...\n");
+}
+
+int main(int argc, char** argv) {
+  vector<RenderJob> jobs;
+  size_t num_threads = 1;
+  size_t block_size = kMaxBlockSize;
+  bool raw = false;
+  
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+      num_threads = max(atoi(argv[++i]), 1);
+    } else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+      block_size = max(atoi(argv[++i]), 1);
+    } else if (!strcmp(argv[i], "-raw")) {
+      raw = true;
+    } else if (argv[i][0] == '-') {
+      Usage();
+      return 1;
+    } else {
+      RenderJob job;
+      job.score_file_name = argv[i];
+      job.raw = raw;
+      job.block_size = min(block_size, kMaxBlockSize);
+      jobs.push_back(job);
+    }
+  }
+  if (jobs.empty()) {
+    Usage();
+    return 1;
+  }
+  
+  num_threads = min(num_threads, jobs.size());
+  atomic<size_t> next_job(0);
+  atomic<int> num_failures(0);
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  
+  vector<thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.push_back(thread([&]() {
+      _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+      size_t i;
+      while ((i = next_job.fetch_add(1)) < jobs.size()) {
+        double real_time_factor = 0.0;
+        if (Render(jobs[i], &real_time_factor)) {
+          printf("%s: %.1fx real time\n",
+              jobs[i].score_file_name, real_time_factor);
+        } else {
+          ++num_failures;
+        }
+      }
+    }));
+  }
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads[t].join();
+  }
+  
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  printf("%zu scores rendered in %.2fs on %zu threads, %d failed\n",
+      jobs.size(), elapsed.count(), num_threads, num_failures.load());
+  return num_failures ? 1 : 0;
+}
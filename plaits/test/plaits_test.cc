@@ -18,6 +18,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 #include <xmmintrin.h>
 
 #include "plaits/dsp/dsp.h"
@@ -40,6 +41,7 @@
 #include "plaits/dsp/engine/wavetable_engine.h"
 
 #include "plaits/dsp/engine2/chiptune_engine.h"
+#include "plaits/dsp/engine2/four_op_engine.h"
 #include "plaits/dsp/engine2/phase_distortion_engine.h"
 #include "plaits/dsp/engine2/string_machine_engine.h"
 #include "plaits/dsp/engine2/virtual_analog_vcf_engine.h"
@@ -52,6 +54,7 @@
 #include "plaits/dsp/oscillator/harmonic_oscillator.h"
 #include "plaits/dsp/oscillator/nes_triangle_oscillator.h"
 #include "plaits/dsp/oscillator/oscillator.h"
+#include "plaits/dsp/oscillator/sine_oscillator.h"
 #include "plaits/dsp/oscillator/string_synth_oscillator.h"
 #include "plaits/dsp/oscillator/super_square_oscillator.h"
 #include "plaits/dsp/oscillator/variable_saw_oscillator.h"
@@ -60,7 +63,10 @@
 #include "plaits/dsp/oscillator/wavetable_oscillator.h"
 #include "plaits/dsp/oscillator/z_oscillator.h"
 
+#include "plaits/dsp/fm/patch_library.h"
 #include "plaits/dsp/voice.h"
+#include "plaits/dsp/voice_pool.h"
+#include "plaits/dsp/voice_pool_renderer.h"
 
 #include "plaits/user_data.h"
 #include "plaits/user_data_receiver.h"
@@ -80,7 +86,6 @@ void TestOscillator() {
   wav_writer.Open("plaits_oscillator.wav");
   
   Oscillator osc;
-  osc.Init();
   
   float f = 112.0f / 48000.0f;
   
@@ -96,7 +101,6 @@ void TestVariableShapeOscillator() {
   wav_writer.Open("plaits_variable_shape_oscillator.wav");
   
   VariableShapeOscillator osc;
-  osc.Init();
   
   float master_f = 110.0f / 48000.0f;
   float f = 410.0f / 48000.0f;
@@ -238,7 +242,6 @@ void TestSuperSquareOscillator() {
   wav_writer.Open("plaits_supersquare_oscillator.wav");
   
   SuperSquareOscillator osc;
-  osc.Init();
   
   for (size_t i = 0; i < kSampleRate * 10; i += kAudioBlockSize) {
     float out[kAudioBlockSize];
@@ -294,7 +297,6 @@ void TestZOscillator() {
   wav_writer.Open("plaits_z_oscillator.wav");
   
   ZOscillator osc;
-  osc.Init();
   
   float f0 = 80.0f / 48000.0f;
   float f1 = 250.0f / 48000.0f;
@@ -312,7 +314,6 @@ void TestGrainletOscillator() {
   wav_writer.Open("plaits_grainlet_oscillator.wav");
   
   GrainletOscillator osc;
-  osc.Init();
   
   float f0 = 80.0f / 48000.0f;
   float f1 = 2000.0f / 48000.0f;
@@ -332,7 +333,7 @@ void TestAdditiveEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   AdditiveEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -357,7 +358,7 @@ void TestChordEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   ChordEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -381,7 +382,7 @@ void TestFMEngine() {
   wav_writer.Open("plaits_fm_engine.wav");
   
   FMEngine e;
-  e.Init(NULL);
+  InitEngine(e, NULL);
   e.Reset();
   
   EngineParameters p;
@@ -405,7 +406,7 @@ void TestGrainEngine() {
   wav_writer.Open("plaits_grain_engine.wav");
   
   GrainEngine e;
-  e.Init(NULL);
+  InitEngine(e, NULL);
   e.Reset();
   
   EngineParameters p;
@@ -430,7 +431,7 @@ void TestModalEngine() {
   wav_writer.Open("plaits_modal_engine.wav");
   
   ModalEngine e;
-  e.Init(NULL);
+  InitEngine(e, NULL);
   e.Reset();
   
   EngineParameters p;
@@ -463,7 +464,7 @@ void TestNoiseEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   NoiseEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -488,7 +489,7 @@ void TestParticleEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   ParticleEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -512,8 +513,8 @@ void TestSpeechEngine() {
   wav_writer.Open("plaits_speech_engine.wav");
   
   BufferAllocator allocator(ram_block, 16384);
-  SpeechEngine e;
-  e.Init(&allocator);
+  NaiveSpeechEngine e;
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -547,7 +548,7 @@ void GenerateStringTuningData() {
     
     BufferAllocator allocator(ram_block, 16384);
     StringEngine e;
-    e.Init(&allocator);
+    InitEngine(e, &allocator);
     e.Reset();
     
     EngineParameters p;
@@ -571,7 +572,7 @@ void GenerateStringTuningData() {
   
   BufferAllocator allocator(ram_block, 16384);
   StringEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -600,7 +601,7 @@ void GenerateModalTuningData() {
     
     BufferAllocator allocator(ram_block, 16384);
     ModalEngine e;
-    e.Init(&allocator);
+    InitEngine(e, &allocator);
     e.Reset();
     
     EngineParameters p;
@@ -627,7 +628,7 @@ void TestStringEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   StringEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -661,7 +662,7 @@ void TestSwarmEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   SwarmEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -697,7 +698,7 @@ void TestVirtualAnalogEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   VirtualAnalogEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -725,7 +726,7 @@ void TestPhaseDistortionEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   PhaseDistortionEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -749,7 +750,7 @@ void TestVirtualAnalogVCFEngine() {
   wav_writer.Open("plaits_virtual_analog_vcf_engine.wav");
   
   VirtualAnalogVCFEngine e;
-  e.Init(NULL);
+  InitEngine(e, NULL);
   e.Reset();
   
   EngineParameters p;
@@ -775,7 +776,7 @@ void TestStringMachineEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   StringMachineEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -800,7 +801,7 @@ void TestChiptuneEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   ChiptuneEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -819,10 +820,6 @@ void TestChiptuneEngine() {
               ? TRIGGER_RISING_EDGE
               : TRIGGER_LOW);
     
-    e.set_envelope_shape(p.trigger == TRIGGER_UNPATCHED
-        ? ChiptuneEngine::NO_ENVELOPE
-        : 2.0f * wav_writer.triangle(23) - 1.0f);
-    
     bool already_enveloped;
     e.Render(p, out, aux, kAudioBlockSize, &already_enveloped);
     wav_writer.Write(out, aux, kAudioBlockSize);
@@ -834,7 +831,7 @@ void TestWaveshapingEngine() {
   wav_writer.Open("plaits_waveshaping_engine.wav");
   
   WaveshapingEngine e;
-  e.Init(NULL);
+  InitEngine(e, NULL);
   e.Reset();
   
   EngineParameters p;
@@ -859,7 +856,7 @@ void TestWavetableEngine() {
   
   WavetableEngine e;
   BufferAllocator allocator(ram_block, 16384);
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   e.LoadUserData(NULL);
   
@@ -887,7 +884,7 @@ void TestWaveTerrainEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   WaveTerrainEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   int8_t custom_terrain[4096];
@@ -920,7 +917,7 @@ void EnumerateWavetables() {
   wav_writer.Open("plaits_wavetable_enumeration.wav");
   
   WavetableEngine e;
-  e.Init(NULL);
+  InitEngine(e, NULL);
   e.Reset();
   
   EngineParameters p;
@@ -955,7 +952,6 @@ void TestSampleRateReducer() {
   
   SampleRateReducer src;
   SineOscillator osc;
-  osc.Init();
   src.Init();
   
   float f0 = 100.0f / 48000.0f;
@@ -977,7 +973,7 @@ void TestBassDrumEngine() {
   wav_writer.Open("plaits_bass_drum_engine.wav");
   
   BassDrumEngine e;
-  e.Init(NULL);
+  InitEngine(e, NULL);
   e.Reset();
   
   EngineParameters p;
@@ -1006,7 +1002,7 @@ void TestSnareDrumEngine() {
   wav_writer.Open("plaits_snare_drum_engine.wav");
   
   SnareDrumEngine e;
-  e.Init(NULL);
+  InitEngine(e, NULL);
   e.Reset();
   
   EngineParameters p;
@@ -1039,7 +1035,7 @@ void TestHiHatEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   HiHatEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   
   EngineParameters p;
@@ -1260,7 +1256,7 @@ void TestSixOpEngine() {
   
   BufferAllocator allocator(ram_block, 16384);
   SixOpEngine e;
-  e.Init(&allocator);
+  InitEngine(e, &allocator);
   e.Reset();
   e.LoadUserData(fm_patches_table[0]);
   
@@ -0,0 +1,677 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Unit checks for the DSP code, run by make check.
+//
+// Unlike the listening tests of plaits_test, each check compares the code
+// against a reference or an invariant, prints one OK or FAIL line, and the
+// program exits with an error if any check fails.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <xmmintrin.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif  // __linux__
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/dsp/engine2/four_op_engine.h"
+#include "plaits/dsp/engine2/six_op_engine.h"
+#include "plaits/dsp/engine2/strum_engine.h"
+#include "plaits/dsp/fm/envelope.h"
+#include "plaits/dsp/fm/patch_library.h"
+#include "plaits/dsp/fm/voice.h"
+#include "plaits/dsp/oscillator/sine_oscillator.h"
+#include "plaits/dsp/physical_modelling/string.h"
+#include "plaits/dsp/physical_modelling/string_bank.h"
+#include "plaits/dsp/simd.h"
+#include "plaits/dsp/voice_pool.h"
+#include "plaits/dsp/voice_pool_renderer.h"
+#include "plaits/fm_patch_vmem.hh"
+#include "plaits/resources.h"
+
+using namespace std;
+using namespace stmlib;
+using namespace plaits;
+
+const size_t kAudioBlockSize = 24;
+
+char ram_block[16 * 1024];
+
+bool Report(const char* name, bool ok, const char* details) {
+  printf("%-24s %s (%s)\n", name, ok ? "OK" : "FAIL", details);
+  return ok;
+}
+
+// Envelope::RenderAtSample() as it was before the stage start times were
+// precomputed: walks through the stages from the beginning on every call, and
+// recurses to find the level reached at the end of the gate.
+template<bool reshape_ascending_segments>
+float ScrubEnvelopeShape(
+    const fm::EnvelopeShape<4>& shape, float t, float gate_duration,
+    float start_level = -100.0f) {
+  const int n = 4;
+  int stage = 0;
+  float phase = 0.0f;
+  if (t > gate_duration) {
+    phase = (t - gate_duration) * shape.increment[n - 1];
+    if (phase >= 1.0f) {
+      return shape.level[n - 1];
+    }
+    stage = n - 1;
+    start_level = ScrubEnvelopeShape<reshape_ascending_segments>(
+        shape, gate_duration, gate_duration);
+  } else {
+    for (; stage < n - 1; ++stage) {
+      const float stage_duration = 1.0f / shape.increment[stage];
+      if (t < stage_duration) {
+        break;
+      }
+      t -= stage_duration;
+    }
+    if (stage == n - 1) {
+      return shape.level[n - 2];
+    }
+    phase = t * shape.increment[stage];
+  }
+  float from = start_level == -100.0f
+      ? shape.level[(stage - 1 + n) % n]
+      : start_level;
+  float to = shape.level[stage];
+  if (reshape_ascending_segments && from < to) {
+    from = max(6.7f, from);
+    to = max(6.7f, to);
+    phase *= (2.5f - phase) * 0.666667f;
+  }
+  return phase * (to - from) + from;
+}
+
+// Scrubs the operator and pitch envelopes of the built-in patches forward,
+// backward, by random jumps across several stages, and around the end of the
+// gate, and compares the incremental RenderAtSample() with the evaluation
+// from scratch.
+bool CheckEnvelopeScrub() {
+  const float gate_duration = 1.5f * kSampleRate;
+
+  vector<float> times;
+  for (float t = 0.0f; t < 2.0f * gate_duration; t += 37.0f) {
+    times.push_back(t);  // Forward.
+  }
+  for (float t = 2.0f * gate_duration; t >= 0.0f; t -= 53.0f) {
+    times.push_back(t);  // Backward.
+  }
+  uint32_t seed = 1;
+  for (int i = 0; i < 4096; ++i) {
+    seed = seed * 1664525 + 1013904223;
+    const float t = float((seed >> 8) % uint32_t(2.0f * gate_duration));
+    times.push_back(t);  // Jumps, possibly across several stages...
+    times.push_back(t);  // ...followed by the same position, as in sustain.
+  }
+  for (int i = -8; i <= 8; ++i) {
+    times.push_back(gate_duration + float(i));  // End of the gate.
+    times.push_back(gate_duration - float(i) * 0.25f);
+  }
+
+  float max_error = 0.0f;
+  for (int bank = 0; bank < 3; ++bank) {
+    for (size_t p = 0; p < fm::PatchLibrary::kNumPatchesPerBank; ++p) {
+      fm::Patch patch;
+      patch.Unpack(fm_patches_table[bank] + p * fm::Patch::SYX_SIZE);
+      const fm::Voice<6>::PatchSetup setup =
+          fm::Voice<6>::PatchSetup::Compute(patch);
+
+      fm::Envelope<1.0f, 4, false> pitch_envelope;
+      fm::Envelope<1.0f, 4, true> operator_envelope[6];
+      pitch_envelope.Set(&setup.pitch_envelope);
+      for (int i = 0; i < 6; ++i) {
+        operator_envelope[i].Set(&setup.operator_envelope[i]);
+      }
+
+      for (float t : times) {
+        float error = fabsf(
+            pitch_envelope.RenderAtSample(t, gate_duration) -
+            ScrubEnvelopeShape<false>(setup.pitch_envelope, t, gate_duration));
+        for (int i = 0; i < 6; ++i) {
+          error = max(error, fabsf(
+              operator_envelope[i].RenderAtSample(t, gate_duration) -
+              ScrubEnvelopeShape<true>(
+                  setup.operator_envelope[i], t, gate_duration)));
+        }
+        max_error = max(max_error, error);
+      }
+    }
+  }
+  char details[64];
+  snprintf(details, sizeof(details), "max error %g", max_error);
+  return Report("EnvelopeScrub", max_error < 1e-3f, details);
+}
+
+// Accuracy of the two SinePM() kernels against sin() in double precision:
+// largest error over the whole cycle, and signal-to-error ratio of a carrier
+// phase-modulated with increasing indices. The vector SinePMPoly() must match
+// the scalar one.
+bool CheckSinePMAccuracy() {
+  double lut_error = 0.0;
+  double poly_error = 0.0;
+  for (uint64_t phase = 0; phase < (1ULL << 32); phase += 997) {
+    double reference = sin(2.0 * M_PI * double(phase) / 4294967296.0);
+    lut_error = max(lut_error, fabs(SinePM(phase, 0.0f) - reference));
+    poly_error = max(poly_error, fabs(SinePMPoly(phase, 0.0f) - reference));
+  }
+
+  const uint32_t carrier_frequency = 39370533;  // 440 Hz.
+  const uint32_t modulator_frequency = 118111601;  // 1320 Hz.
+  double min_lut_snr = 1000.0;
+  double min_poly_snr = 1000.0;
+  size_t num_vector_differences = 0;
+  for (float index = 0.5f; index <= 16.0f; index *= 2.0f) {
+    uint32_t carrier_phase = 0;
+    uint32_t modulator_phase = 0;
+    double signal = 0.0;
+    double lut_noise = 0.0;
+    double poly_noise = 0.0;
+    for (size_t i = 0; i < kSampleRate * 10; ++i) {
+      carrier_phase += carrier_frequency;
+      modulator_phase += modulator_frequency;
+      float pm = index * float(
+          sin(2.0 * M_PI * double(modulator_phase) / 4294967296.0));
+      // Phase quantized as SinePM() does, so that only the sine is compared.
+      uint32_t phase = carrier_phase +
+          static_cast<uint32_t>((pm + 32.0f) * 67108864.0f) * 64;
+      double reference = sin(2.0 * M_PI * double(phase) / 4294967296.0);
+      double lut = SinePM(carrier_phase, pm) - reference;
+      double poly = SinePMPoly(carrier_phase, pm) - reference;
+      signal += reference * reference;
+      lut_noise += lut * lut;
+      poly_noise += poly * poly;
+
+      // Each lane with its own phase offset, against the scalar kernel.
+      uint32_t phases[simd::kNumLanes];
+      float pms[simd::kNumLanes];
+      float vector_out[simd::kNumLanes];
+      for (size_t j = 0; j < simd::kNumLanes; ++j) {
+        phases[j] = carrier_phase + uint32_t(j) * 0x10000001u;
+        pms[j] = j & 1 ? -pm : pm;
+      }
+      simd::Store(vector_out, SinePMPoly(
+          simd::Load(phases), simd::Load(pms)));
+      for (size_t j = 0; j < simd::kNumLanes; ++j) {
+        num_vector_differences +=
+            vector_out[j] != SinePMPoly(phases[j], pms[j]);
+      }
+    }
+    min_lut_snr = min(min_lut_snr, 10.0 * log10(signal / lut_noise));
+    min_poly_snr = min(min_poly_snr, 10.0 * log10(signal / poly_noise));
+  }
+
+  char details[128];
+  snprintf(details, sizeof(details),
+           "max error lut %.3g, poly %.3g; SNR lut %.1f dB, poly %.1f dB; "
+           "%zu vector differences",
+           lut_error, poly_error, min_lut_snr, min_poly_snr,
+           num_vector_differences);
+  return Report(
+      "SinePMAccuracy",
+      poly_error < 3e-7 && min_poly_snr > 140.0 && !num_vector_differences,
+      details);
+}
+
+// Plays chords of 4 notes, each on a different patch, on a new engine.
+// Returns the number of voices sounding at the end of the first chord, before
+// any note is released.
+int RenderFourOpChords(
+    int polyphony, const uint8_t* user_data, vector<float>* out) {
+  BufferAllocator allocator(ram_block, sizeof(ram_block));
+  FourOpEngine* e = new FourOpEngine;
+  FourOpEngine::Bank* user_bank = new FourOpEngine::Bank;
+  InitEngine(*e, &allocator);
+  e->set_user_bank(user_bank);
+  e->LoadUserData(user_data);
+  e->set_polyphony(polyphony);
+  e->Reset();
+
+  EngineParameters p;
+  p.accent = 0.8f;
+  p.timbre = 0.5f;
+  p.morph = 0.5f;
+
+  const float chord[] = { 0.0f, 7.0f, 16.0f, 10.0f };
+  const size_t note_duration = kSampleRate / 8;
+  int num_active_voices = 0;
+  for (size_t i = 0; i < kSampleRate * 8; i += kAudioBlockSize) {
+    const size_t note = i / note_duration;
+    p.trigger = (note % 16) < 12 ? TRIGGER_HIGH : TRIGGER_LOW;
+    if (i % note_duration == 0 && (note % 16) < 4) {
+      p.trigger |= TRIGGER_RISING_EDGE;
+      p.note = 48.0f + chord[note % 4];
+      p.harmonics = float(note / 16);
+    }
+    float block[kAudioBlockSize];
+    float aux[kAudioBlockSize];
+    bool already_enveloped;
+    e->Render(p, block, aux, kAudioBlockSize, &already_enveloped);
+    out->insert(out->end(), &block[0], &block[kAudioBlockSize]);
+    if (note == 4) {
+      num_active_voices = max(num_active_voices, e->num_active_voices());
+    }
+  }
+  delete user_bank;
+  delete e;
+  return num_active_voices;
+}
+
+// The chords use as many voices as they have notes, or as the polyphony
+// allows, and a user bank holding the built-in patches sounds the same as the
+// built-in bank.
+bool CheckFourOpEngine() {
+  vector<float> built_in;
+  vector<float> mono;
+  const int chord_voices = RenderFourOpChords(8, NULL, &built_in);
+  const int mono_voices = RenderFourOpChords(1, NULL, &mono);
+
+  bool finite = true;
+  float peak = 0.0f;
+  for (float s : built_in) {
+    finite = finite && isfinite(s);
+    peak = max(peak, fabsf(s));
+  }
+
+  vector<uint8_t> user_data;
+  while (user_data.size() < FourOpEngine::kBankSize) {
+    user_data.insert(
+        user_data.end(), &vmem_bank_0[0], &vmem_bank_0[sizeof(vmem_bank_0)]);
+  }
+  vector<float> user;
+  RenderFourOpChords(8, user_data.data(), &user);
+
+  char details[128];
+  snprintf(details, sizeof(details),
+           "%d voices, %d with polyphony 1, peak %.2f, user bank %s",
+           chord_voices, mono_voices, peak,
+           user == built_in ? "identical" : "different");
+  return Report(
+      "FourOpEngine",
+      chord_voices == 4 && mono_voices == 1 && finite && peak > 0.01f &&
+          user == built_in,
+      details);
+}
+
+// Writes the built-in banks as a SysEx file, with a corrupted copy of the
+// last one, and loads it into a library.
+bool CheckFMPatchLibrary() {
+  const char* file_name = "plaits_patch_library.syx";
+  const size_t kDumpSize = fm::PatchLibrary::kBulkDumpSize;
+  uint8_t dump[kDumpSize];
+  FILE* fp = fopen(file_name, "wb");
+  for (int bank = 0; bank < 4; ++bank) {
+    const uint8_t* data = fm_patches_table[min(bank, 2)];
+    const uint8_t header[] = { 0xf0, 0x43, 0x00, 0x09, 0x20, 0x00 };
+    copy(&header[0], &header[6], &dump[0]);
+    copy(&data[0], &data[fm::PatchLibrary::kBankSize], &dump[6]);
+    uint8_t sum = 0;
+    for (size_t i = 0; i < fm::PatchLibrary::kBankSize; ++i) {
+      sum += data[i];
+    }
+    dump[kDumpSize - 2] = ((-sum) & 0x7f) ^ (bank == 3 ? 1 : 0);
+    dump[kDumpSize - 1] = 0xf7;
+    fwrite(dump, 1, kDumpSize, fp);
+  }
+  fclose(fp);
+
+  fm::PatchLibrary* library = new fm::PatchLibrary(16);
+  const size_t num_patches = library->AddFile(file_name);
+  bool ok = num_patches == 96 && library->num_rejected_banks() == 1;
+
+  // Find() returns the first patch with a name.
+  size_t num_find_errors =
+      library->Find("NO SUCH") != fm::PatchLibrary::kNotFound;
+  for (size_t i = 0; i < num_patches; ++i) {
+    size_t first = 0;
+    while (library->name(first) != library->name(i)) {
+      ++first;
+    }
+    num_find_errors += library->Find(library->name(i)) != first;
+  }
+
+  // Only prepared patches are acquired, and they match the built-in ones.
+  size_t num_patch_errors = 0;
+  for (size_t i = 0; i < num_patches; ++i) {
+    num_patch_errors += library->Acquire(i) != NULL;
+    library->Prepare(i);
+    const fm::PatchLibrary::CachedPatch* p = library->Acquire(i);
+    fm::Patch patch;
+    patch.Unpack(fm_patches_table[i / 32] + (i % 32) * fm::Patch::SYX_SIZE);
+    num_patch_errors += !p || memcmp(&p->patch, &patch, sizeof(patch));
+    if (p) {
+      library->Release(i);
+    }
+  }
+  const size_t num_misses = library->num_misses();
+  ok = ok && num_misses == num_patches;
+
+  // When every slot is pinned, the cache is full.
+  for (size_t i = 0; i < library->cache_size(); ++i) {
+    library->Prepare(i);
+    num_patch_errors += !library->Acquire(i);
+  }
+  library->Prepare(num_patches - 1);
+  num_patch_errors += library->Acquire(num_patches - 1) != NULL;
+  for (size_t i = 0; i < library->cache_size(); ++i) {
+    library->Release(i);
+  }
+
+  // With the patches prepared as HARMONICS changes, the engine never misses.
+  BufferAllocator allocator(ram_block, sizeof(ram_block));
+  SixOpEngine* e = new SixOpEngine;
+  InitEngine(*e, &allocator);
+  e->set_patch_library(library);
+  EngineParameters p;
+  p.note = 48.0f;
+  p.accent = 0.8f;
+  p.timbre = 0.5f;
+  p.morph = 0.5f;
+  float peak = 0.0f;
+  for (size_t i = 0; i < kSampleRate * 8; i += kAudioBlockSize) {
+    const size_t note = i / (kSampleRate / 4);
+    p.trigger = TRIGGER_HIGH;
+    p.trigger |= (i % size_t(kSampleRate / 4)) == 0
+        ? TRIGGER_RISING_EDGE : TRIGGER_LOW;
+    p.harmonics = float((note * 5) % num_patches);
+    e->PreparePatch(p.harmonics);
+    float out[kAudioBlockSize];
+    float aux[kAudioBlockSize];
+    bool already_enveloped;
+    e->Render(p, out, aux, kAudioBlockSize, &already_enveloped);
+    for (float s : out) {
+      peak = isfinite(s) ? max(peak, fabsf(s)) : 1e9f;
+    }
+  }
+  e->set_patch_library(NULL);
+  const size_t num_engine_misses = library->num_misses() - num_misses;
+  ok = ok && num_engine_misses == 0 && peak > 0.01f && peak <= 1.0f;
+  delete e;
+  delete library;
+  remove(file_name);
+
+  char details[128];
+  snprintf(details, sizeof(details),
+           "%zu patches, %zu find errors, %zu patch errors, %zu engine misses",
+           num_patches, num_find_errors, num_patch_errors, num_engine_misses);
+  return Report(
+      "FMPatchLibrary", ok && !num_find_errors && !num_patch_errors, details);
+}
+
+// Plays chords on a pool with one voice per engine, rendered by
+// VoicePool::Render(), then by a VoicePoolRenderer with 1, 2 and as many
+// threads as there are cores. The mixes must be bit-identical, including the
+// noise of the engines drawing from the random generator.
+bool CheckVoicePoolRenderer() {
+  typedef VoicePool<kMaxEngines> Pool;
+  const size_t kNumBlocks = size_t(kSampleRate) * 2 / kAudioBlockSize;
+  const size_t kNotePeriod = 200;
+  const size_t max_threads = max(3u, thread::hardware_concurrency());
+  const size_t thread_counts[] = { 0, 1, 2, max_threads };
+
+#ifdef __linux__
+  cpu_set_t affinity;
+  sched_getaffinity(0, sizeof(affinity), &affinity);
+#endif  // __linux__
+
+  vector<float> reference;
+  size_t num_differences = 0;
+  bool stats_ok = true;
+  for (size_t num_threads : thread_counts) {
+    vector<char> ram(Pool::kRamSize);
+    Pool* pool = new Pool;
+    pool->Init(ram.data(), ram.size());
+    for (size_t i = 0; i < Pool::kNumVoices; ++i) {
+      Patch* patch = pool->mutable_patch(i);
+      *patch = Patch();
+      patch->engine = int(i);
+      patch->harmonics = 0.3f + 0.02f * float(i);
+      patch->timbre = 0.6f;
+      patch->morph = 0.4f;
+      patch->decay = 0.5f;
+      patch->lpg_colour = 0.5f;
+    }
+
+    // Pinned workers, to check that the caller keeps its affinity.
+    VoicePoolRenderer<Pool>* renderer = new VoicePoolRenderer<Pool>;
+    if (num_threads) {
+      renderer->Init(pool, num_threads, true);
+    }
+
+    vector<float> mix;
+    for (size_t block = 0; block < kNumBlocks; ++block) {
+      if (block % kNotePeriod == 0) {
+        const size_t n = block / kNotePeriod;
+        for (size_t i = 0; i < Pool::kNumVoices; ++i) {
+          if (n) {
+            pool->NoteOff(24.0f + float(((n - 1) * 7 + i * 3) % 72), i);
+          }
+          pool->NoteOn(24.0f + float((n * 7 + i * 3) % 72), 0.8f, i);
+        }
+      }
+      float out[kAudioBlockSize];
+      float aux[kAudioBlockSize];
+      if (num_threads) {
+        renderer->Render(out, aux, kAudioBlockSize);
+      } else {
+        pool->Render(out, aux, kAudioBlockSize);
+      }
+      mix.insert(mix.end(), &out[0], &out[kAudioBlockSize]);
+      mix.insert(mix.end(), &aux[0], &aux[kAudioBlockSize]);
+    }
+    if (num_threads) {
+      stats_ok = stats_ok && renderer->stats().num_blocks == kNumBlocks;
+    }
+    delete renderer;
+    delete pool;
+
+    if (!num_threads) {
+      reference = mix;
+    } else {
+      for (size_t i = 0; i < mix.size(); ++i) {
+        num_differences += mix[i] != reference[i];
+      }
+    }
+  }
+
+  bool affinity_ok = true;
+#ifdef __linux__
+  cpu_set_t new_affinity;
+  sched_getaffinity(0, sizeof(new_affinity), &new_affinity);
+  affinity_ok = CPU_EQUAL(&affinity, &new_affinity);
+#endif  // __linux__
+
+  char details[128];
+  snprintf(details, sizeof(details),
+           "1, 2, %zu threads: %zu different samples%s%s",
+           max_threads, num_differences,
+           stats_ok ? "" : ", blocks not counted",
+           affinity_ok ? "" : ", caller pinned");
+  return Report(
+      "VoicePoolRenderer", !num_differences && stats_ok && affinity_ok,
+      details);
+}
+
+// Feeds the same excitation to one string of a bank and to a String tuned
+// like it, and returns the ratio of the difference to the String's output, in
+// dB. The other strings of the bank receive no input.
+template<size_t num_strings>
+float CompareStringBankLane(
+    StringBank<num_strings>* bank, size_t lane, const float* f0,
+    float non_linearity, float brightness, float damping) {
+  for (size_t i = 0; i < num_strings; ++i) {
+    bank->set_f0(i, f0[i]);
+    bank->set_input_gain(i, i == lane ? 1.0f : 0.0f);
+  }
+  bank->Reset();
+  String string;
+  string.Reset();
+
+  double signal = 0.0;
+  double noise = 0.0;
+  uint32_t seed = 1;
+  for (size_t n = 0; n < kSampleRate / 2; n += kAudioBlockSize) {
+    float in[kAudioBlockSize];
+    float bank_out[kAudioBlockSize] = { };
+    float string_out[kAudioBlockSize] = { };
+    for (size_t i = 0; i < kAudioBlockSize; ++i) {
+      seed = seed * 1664525 + 1013904223;
+      in[i] = n < 480 ? float(int32_t(seed)) / 2147483648.0f * 0.5f : 0.0f;
+    }
+    bank->Process(
+        non_linearity, brightness, damping, in, bank_out, kAudioBlockSize);
+    string.Process(
+        f0[lane], non_linearity, brightness, damping, in, string_out,
+        kAudioBlockSize);
+    for (size_t i = 0; i < kAudioBlockSize; ++i) {
+      const double error = bank_out[i] - string_out[i];
+      signal += double(string_out[i]) * double(string_out[i]);
+      noise += error * error;
+    }
+  }
+  return 10.0f * log10f(float((noise + 1e-30) / (signal + 1e-30)));
+}
+
+// Every lane of a bank of 1 and of 6 strings plays as a single String, with
+// both non-linearities (the dispersion below the amount where it adds noise).
+bool CheckStringBank() {
+  const float f0_1[] = { NoteToInc(48.0f) };
+  const float f0_6[] = {
+      NoteToInc(40.0f), NoteToInc(45.0f), NoteToInc(50.0f),
+      NoteToInc(55.0f), NoteToInc(59.0f), NoteToInc(64.0f) };
+  const float non_linearities[] = { -0.6f, 0.0f, 0.5f };
+
+  vector<char> ram_1(StringBank<1>::kSharedRamSize);
+  BufferAllocator allocator_1(ram_1.data(), ram_1.size());
+  StringBank<1>* bank_1 = new StringBank<1>;
+  bank_1->Init(&allocator_1);
+  vector<char> ram_6(StringBank<6>::kSharedRamSize);
+  BufferAllocator allocator_6(ram_6.data(), ram_6.size());
+  StringBank<6>* bank_6 = new StringBank<6>;
+  bank_6->Init(&allocator_6);
+
+  float worst = -1000.0f;
+  for (float non_linearity : non_linearities) {
+    worst = max(worst, CompareStringBankLane(
+        bank_1, 0, f0_1, non_linearity, 0.5f, 0.7f));
+    for (size_t lane = 0; lane < 6; ++lane) {
+      worst = max(worst, CompareStringBankLane(
+          bank_6, lane, f0_6, non_linearity, 0.3f + 0.1f * float(lane), 0.8f));
+    }
+  }
+  delete bank_6;
+  delete bank_1;
+
+  char details[64];
+  snprintf(details, sizeof(details), "largest difference %.1f dB", worst);
+  return Report("StringBank", worst < -80.0f, details);
+}
+
+// Renders 4 seconds of a strum engine, with a new chord every second, and
+// returns the number of strums and the length of the longest one.
+int RenderStrums(bool patched, vector<float>* out, size_t* strum_length) {
+  vector<char> ram(StrumEngine::kSharedRamSize);
+  BufferAllocator allocator(ram.data(), ram.size());
+  StrumEngine* e = new StrumEngine;
+  InitEngine(*e, &allocator);
+
+  EngineParameters p;
+  p.note = 48.0f;
+  p.accent = 0.8f;
+  p.timbre = 0.5f;
+  p.morph = 0.6f;
+
+  int num_strums = 0;
+  size_t start = 0;
+  *strum_length = 0;
+  bool strumming = false;
+  for (size_t i = 0; i < kSampleRate * 4; i += kAudioBlockSize) {
+    // Unpatched, the chord changes every other second only.
+    const size_t second = i / size_t(kSampleRate);
+    p.harmonics = float(patched ? second : second / 2);
+    p.trigger = patched
+        ? (i % size_t(kSampleRate) == 0 ? TRIGGER_RISING_EDGE : TRIGGER_LOW)
+        : TRIGGER_UNPATCHED;
+    float block[kAudioBlockSize];
+    float aux[kAudioBlockSize];
+    bool already_enveloped;
+    e->Render(p, block, aux, kAudioBlockSize, &already_enveloped);
+    out->insert(out->end(), &block[0], &block[kAudioBlockSize]);
+    if (e->strumming() && !strumming) {
+      ++num_strums;
+      start = i;
+    } else if (!e->strumming() && strumming) {
+      *strum_length = max(*strum_length, i - start);
+    }
+    strumming = e->strumming();
+  }
+  delete e;
+  return num_strums;
+}
+
+// A strum plucks its 6 strings 12 ms apart, on a trigger or, unpatched, on a
+// change of chord.
+bool CheckStrumEngine() {
+  vector<float> out;
+  size_t patched_length = 0;
+  size_t unpatched_length = 0;
+  const int patched_strums = RenderStrums(true, &out, &patched_length);
+  const int unpatched_strums = RenderStrums(false, &out, &unpatched_length);
+
+  bool finite = true;
+  float peak = 0.0f;
+  for (float s : out) {
+    finite = finite && isfinite(s);
+    peak = max(peak, fabsf(s));
+  }
+
+  // The last pluck is 5 intervals after the first, rounded up to a block.
+  const size_t expected_length =
+      (size_t(0.012f * kSampleRate * 5.0f) + kAudioBlockSize - 1) /
+      kAudioBlockSize * kAudioBlockSize;
+  char details[128];
+  snprintf(details, sizeof(details),
+           "%d strums patched, %d unpatched, %zu samples long, peak %.2f",
+           patched_strums, unpatched_strums, patched_length, peak);
+  return Report(
+      "StrumEngine",
+      patched_strums == 4 && unpatched_strums == 2 &&
+          patched_length == expected_length &&
+          unpatched_length == expected_length && finite && peak > 0.05f &&
+          peak < 1.0f,
+      details);
+}
+
+int main(void) {
+  _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+  int num_failures = 0;
+  num_failures += !CheckEnvelopeScrub();
+  num_failures += !CheckSinePMAccuracy();
+  num_failures += !CheckFourOpEngine();
+  num_failures += !CheckFMPatchLibrary();
+  num_failures += !CheckVoicePoolRenderer();
+  num_failures += !CheckStringBank();
+  num_failures += !CheckStrumEngine();
+  printf("%d failures\n", num_failures);
+  return num_failures ? 1 : 0;
+}
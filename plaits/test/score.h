@@ -0,0 +1,287 @@
+// Copyright 2026 The ToySynth Authors.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Text score driving a Voice, for offline rendering.
+//
+// One event per line: a time in seconds, a parameter name and a value.
+// Blank lines and lines starting with # are ignored.
+//
+//   # time  parameter  value
+//   0.0     engine     8
+//   0.0     note       48
+//   0.0     trigger    1
+//   0.25    trigger    0
+//   0.5     timbre     0.8
+//   4.0     end        0
+//
+// Patch parameters: engine harmonics timbre morph decay lpg_colour
+//   fm_amount timbre_amount morph_amount.
+// Modulations: note trigger level frequency engine_cv.
+// The trigger and level inputs are considered patched as soon as the score
+// contains one of their events. The first note of the score (48 without note
+// events) is the patch note, and notes are scheduled as the note modulation,
+// relative to it. "end" sets the duration of the render.
+
+#ifndef PLAITS_TEST_SCORE_H_
+#define PLAITS_TEST_SCORE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/dsp/voice.h"
+
+namespace plaits {
+
+enum ScoreParameter {
+  SCORE_ENGINE,
+  SCORE_NOTE,
+  SCORE_HARMONICS,
+  SCORE_TIMBRE,
+  SCORE_MORPH,
+  SCORE_DECAY,
+  SCORE_LPG_COLOUR,
+  SCORE_FM_AMOUNT,
+  SCORE_TIMBRE_AMOUNT,
+  SCORE_MORPH_AMOUNT,
+  SCORE_TRIGGER,
+  SCORE_LEVEL,
+  SCORE_FREQUENCY,
+  SCORE_ENGINE_CV,
+  SCORE_END,
+  SCORE_LAST
+};
+
+static const char* const score_parameter_names[SCORE_LAST] = {
+  "engine",
+  "note",
+  "harmonics",
+  "timbre",
+  "morph",
+  "decay",
+  "lpg_colour",
+  "fm_amount",
+  "timbre_amount",
+  "morph_amount",
+  "trigger",
+  "level",
+  "frequency",
+  "engine_cv",
+  "end"
+};
+
+struct ScoreEvent {
+  size_t sample;
+  ScoreParameter parameter;
+  float value;
+};
+
+class Score {
+ public:
+  Score() { }
+  ~Score() { }
+
+  // Returns false and prints the offending line on parse errors.
+  bool Load(const char* file_name) {
+    FILE* fp = fopen(file_name, "r");
+    if (!fp) {
+      fprintf(stderr, "%s: cannot open file\n", file_name);
+      return false;
+    }
+    events_.clear();
+    duration_ = 0;
+    trigger_patched_ = false;
+    level_patched_ = false;
+    
+    char line[256];
+    int line_number = 0;
+    bool success = true;
+    while (fgets(line, sizeof(line), fp)) {
+      ++line_number;
+      char* comment = strchr(line, '#');
+      if (comment) {
+        *comment = '\0';
+      }
+      double time;
+      char name[32];
+      float value;
+      int n = sscanf(line, "%lf %31s %f", &time, name, &value);
+      if (n == EOF) {
+        continue;
+      }
+      int parameter = n == 3 ? Lookup(name) : -1;
+      if (parameter == -1 || time < 0.0) {
+        fprintf(stderr, "%s:%d: syntax error\n", file_name, line_number);
+        success = false;
+        break;
+      }
+      ScoreEvent e;
+      e.sample = static_cast<size_t>(time * kSampleRate + 0.5);
+      e.parameter = static_cast<ScoreParameter>(parameter);
+      e.value = value;
+      events_.push_back(e);
+      duration_ = std::max(duration_, e.sample);
+      trigger_patched_ = trigger_patched_ || e.parameter == SCORE_TRIGGER;
+      level_patched_ = level_patched_ || e.parameter == SCORE_LEVEL;
+    }
+    fclose(fp);
+    std::stable_sort(
+        events_.begin(),
+        events_.end(),
+        [](const ScoreEvent& a, const ScoreEvent& b) {
+          return a.sample < b.sample;
+        });
+    first_note_ = 48.0f;
+    for (const ScoreEvent& e : events_) {
+      if (e.parameter == SCORE_NOTE) {
+        first_note_ = e.value;
+        break;
+      }
+    }
+    return success;
+  }
+  
+  // Default patch and modulations, before any event is applied.
+  void Reset(Patch* patch, Modulations* modulations) const {
+    patch->engine = 0;
+    patch->note = first_note_;
+    patch->harmonics = 0.5f;
+    patch->timbre = 0.5f;
+    patch->morph = 0.5f;
+    patch->frequency_modulation_amount = 0.0f;
+    patch->timbre_modulation_amount = 0.0f;
+    patch->morph_modulation_amount = 0.0f;
+    patch->decay = 0.5f;
+    patch->lpg_colour = 0.5f;
+    
+    *modulations = Modulations();
+    modulations->level = level_patched_ ? 0.0f : 1.0f;
+    modulations->trigger_patched = trigger_patched_;
+    modulations->level_patched = level_patched_;
+  }
+  
+  static void Apply(
+      const ScoreEvent& e,
+      Patch* patch,
+      Modulations* modulations) {
+    switch (e.parameter) {
+      case SCORE_ENGINE: patch->engine = static_cast<int>(e.value); break;
+      case SCORE_NOTE: modulations->note = e.value - patch->note; break;
+      case SCORE_HARMONICS: patch->harmonics = e.value; break;
+      case SCORE_TIMBRE: patch->timbre = e.value; break;
+      case SCORE_MORPH: patch->morph = e.value; break;
+      case SCORE_DECAY: patch->decay = e.value; break;
+      case SCORE_LPG_COLOUR: patch->lpg_colour = e.value; break;
+      case SCORE_FM_AMOUNT: patch->frequency_modulation_amount = e.value; break;
+      case SCORE_TIMBRE_AMOUNT: patch->timbre_modulation_amount = e.value; break;
+      case SCORE_MORPH_AMOUNT: patch->morph_modulation_amount = e.value; break;
+      case SCORE_TRIGGER: modulations->trigger = e.value; break;
+      case SCORE_LEVEL: modulations->level = e.value; break;
+      case SCORE_FREQUENCY:
+        modulations->frequency = e.value;
+        modulations->frequency_patched = true;
+        break;
+      case SCORE_ENGINE_CV: modulations->engine = e.value; break;
+      default: break;
+    }
+  }
+  
+  // Renders the whole score through a voice, by blocks of block_size samples.
+  // Events left by a previous render are cleared first.
+  // Note, trigger and level events are scheduled with sample accuracy; the
+  // other events are applied at the start of the block in which they fall.
+  // When the voice's event queue is full, the block is shortened to end just
+  // before the event that does not fit. Returns false if more events than the
+  // queue can hold share the same sample.
+  // fn(const Voice::Frame* frames, size_t size) receives the output.
+  template<typename F>
+  bool Render(Voice* voice, size_t block_size, F&& fn) const {
+    Patch patch;
+    Modulations modulations;
+    Reset(&patch, &modulations);
+    voice->ClearEvents();
+    
+    std::vector<ScoreEvent>::const_iterator e = events_.begin();
+    Voice::Frame frames[kMaxBlockSize];
+    block_size = std::min(block_size, kMaxBlockSize);
+    for (size_t i = 0; i < duration_; ) {
+      size_t size = std::min(block_size, duration_ - i);
+      while (e != events_.end() && e->sample < i + size) {
+        const VoiceEventType type = EventType(e->parameter);
+        if (type != VOICE_EVENT_LAST) {
+          VoiceEvent event;
+          event.sample = e->sample - i;
+          event.type = type;
+          event.value = type == VOICE_EVENT_NOTE
+              ? e->value - patch.note
+              : e->value;
+          if (!voice->ScheduleEvent(event)) {
+            if (event.sample == 0) {
+              return false;
+            }
+            size = event.sample;
+            break;
+          }
+        } else {
+          Apply(*e, &patch, &modulations);
+        }
+        ++e;
+      }
+      voice->Render(patch, modulations, frames, size);
+      fn(frames, size);
+      i += size;
+    }
+    return true;
+  }
+  
+  inline size_t duration() const { return duration_; }
+  inline const std::vector<ScoreEvent>& events() const { return events_; }
+  
+ private:
+  // The voice event carrying a parameter, or VOICE_EVENT_LAST if it is not
+  // scheduled.
+  static VoiceEventType EventType(ScoreParameter parameter) {
+    switch (parameter) {
+      case SCORE_NOTE: return VOICE_EVENT_NOTE;
+      case SCORE_TRIGGER: return VOICE_EVENT_TRIGGER;
+      case SCORE_LEVEL: return VOICE_EVENT_LEVEL;
+      default: return VOICE_EVENT_LAST;
+    }
+  }
+
+  static int Lookup(const char* name) {
+    for (int i = 0; i < SCORE_LAST; ++i) {
+      if (!strcmp(name, score_parameter_names[i])) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  std::vector<ScoreEvent> events_;
+  size_t duration_;
+  bool trigger_patched_;
+  bool level_patched_;
+  float first_note_;
+  
+  DISALLOW_COPY_AND_ASSIGN(Score);
+};
+
+}  // namespace plaits
+
+#endif  // PLAITS_TEST_SCORE_H_